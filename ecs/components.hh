@@ -1,21 +1,33 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <queue>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
 #include "ecs/entity.hh"
+#include "ecs/profiling.hh"
+#include "ecs/registry.hh"
 #include "ecs/utils.hh"
 
 namespace ecs {
 
 template <typename... Component>
 class ComponentManager {
+public:
+    /// Runtime information about each component (name, size, type erased functions), see registry.hh
+    using Registry = ComponentRegistry<Component...>;
+
 private:
     static constexpr size_t kNumComponents = sizeof...(Component);
     using EntityIndex = std::array<size_t, kNumComponents>;
@@ -31,6 +43,9 @@ private:
         EntityIndex index;
         bool empty;
 
+        // Whether the id is waiting on the free list, this is separate from empty since reserved ids are also empty
+        bool freed = false;
+
         /// Sets the Proxy into a valid state that's ready to use
         void reset() {
             index.fill(kInvalidIndex);
@@ -51,30 +66,106 @@ public:
         return spawn_impl(std::move(c)...);
     }
 
+    ///
+    /// @brief Spawn count entities which each get a copy of the given components. Storage is reserved once up front
+    /// and each component vector is filled in a single pass, so this is much faster than calling spawn() in a loop.
+    /// See Prefab for a convenient way to store the components.
+    ///
+    template <typename... C>
+    std::vector<Entity> spawn_batch(size_t count, const C&... c) {
+        std::vector<Entity> spawned;
+        spawned.reserve(count);
+
+        const size_t reused = std::min(count, free_.size());
+        const size_t required = next_id_.value + count - reused;
+        entities_.reserve(required);
+        active_.reserve((required + kBitsPerWord - 1) / kBitsPerWord);
+
+        for (size_t i = 0; i < count; ++i) {
+            EntityProxy& proxy = allocate();
+            proxy.reset();
+            set_active_bit(proxy.id(), true);
+            spawned.push_back(proxy);
+        }
+
+        (add_batch_impl(spawned, c), ...);
+        return spawned;
+    }
+
+    ///
+    /// @brief Reserve an entity id without creating the entity, this is thread safe and lock free. The entity isn't
+    /// alive until spawn_reserved() is called (from the thread which owns the manager), so it shouldn't be passed to
+    /// any other functions until then. See SpawnBuffer for staging components on worker threads.
+    ///
+    /// NOTE: Reserved ids which are never spawned are leaked, they stay empty and never go on the free list.
+    ///
+    Entity reserve() {
+        constexpr size_t kMaxId = std::numeric_limits<Entity::Id>::max();
+
+        // Don't move the counter past the last id, otherwise spawn() would carry on from an id which doesn't fit
+        size_t id = next_id_.value.load(std::memory_order_relaxed);
+        do {
+            if (id > kMaxId) {
+                throw std::runtime_error("In ComponentManager::reserve(), all " + std::to_string(kMaxId + 1) +
+                                         " entity ids have been used.");
+            }
+        } while (!next_id_.value.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+
+        return Entity::from_id(id);
+    }
+
+    ///
+    /// @brief Bring an entity created with reserve() to life, with the given components
+    ///
+    template <typename... C>
+    Entity spawn_reserved(const Entity& entity, C... c) {
+        if (entity.id() >= next_id_.value) {
+            throw std::runtime_error("In ComponentManager::spawn_reserved(), entity " + std::to_string(entity.id()) +
+                                     " wasn't reserved.");
+        }
+
+        EntityProxy& proxy = proxy_for(entity.id());
+        if (!proxy.empty) {
+            throw std::runtime_error("In ComponentManager::spawn_reserved(), entity " + std::to_string(entity.id()) +
+                                     " has already been spawned.");
+        }
+        if (proxy.freed) {
+            // Reviving it would hand the same id out again from the free list
+            throw std::runtime_error("In ComponentManager::spawn_reserved(), entity " + std::to_string(entity.id()) +
+                                     " was despawned, not reserved.");
+        }
+
+        proxy.reset();
+        set_active_bit(proxy.id(), true);
+        (add_impl<C>(proxy, std::move(c)), ...);
+        return proxy;
+    }
+
     ///
     /// @brief Add the given component to the already constructed entity
     ///
     template <typename... C>
     void add(const Entity& entity) {
         auto& proxy = lookup(entity);
-        (add_impl(proxy.index, C{}), ...);
+        (add_impl(proxy, C{}), ...);
     }
     template <typename... C>
     void add(const Entity& entity, C... c) {
         auto& proxy = lookup(entity);
-        (add_impl(proxy.index, std::move(c)), ...);
+        (add_impl(proxy, std::move(c)), ...);
     }
 
     ///
-    /// @brief A dynamic version of the above function. This will default construct the component.
+    /// @brief A dynamic version of the above function. This will default construct the component (if the entity doesn't
+    /// already have it). The component can also be looked up by name, see ComponentRegistry.
     ///
     void add_by_index(const Entity& entity, size_t component_index) {
-        auto& proxy = lookup(entity);
-        ApplyByIndex{components_}(component_index, [&](auto& components) {
-            proxy.index[component_index] = components.size();
-            components.emplace_back();
-        });
+        using Function = void (ComponentManager::*)(EntityProxy&);
+        static constexpr std::array<Function, kNumComponents> kFunctions{
+            &ComponentManager::add_default_impl<Component>...};
+        (this->*dynamic_lookup(kFunctions, component_index))(lookup(entity));
     }
+    void add_by_name(const Entity& entity, const std::string& name) { add_by_index(entity, Registry::index_of(name)); }
 
     ///
     /// @brief If the entity has the component attached, retrieve a pointer to it.
@@ -121,6 +212,65 @@ public:
             return std::make_tuple(std::cref(get_impl<C>(proxy)), std::cref(get_impl<Cs>(proxy))...);
     }
 
+    ///
+    /// @brief Dynamic versions of get_ptr(), the result can be interpreted using Registry::info(component_index).
+    /// @returns A pointer to the component, or null if the entity doesn't have it
+    ///
+    void* get_by_index(const Entity& entity, size_t component_index) {
+        using Function = void* (ComponentManager::*)(const EntityProxy&);
+        static constexpr std::array<Function, kNumComponents> kFunctions{
+            &ComponentManager::get_erased_impl<Component>...};
+        return (this->*dynamic_lookup(kFunctions, component_index))(lookup(entity));
+    }
+    const void* get_by_index(const Entity& entity, size_t component_index) const {
+        using Function = const void* (ComponentManager::*)(const EntityProxy&) const;
+        static constexpr std::array<Function, kNumComponents> kFunctions{
+            &ComponentManager::get_erased_impl<Component>...};
+        return (this->*dynamic_lookup(kFunctions, component_index))(lookup(entity));
+    }
+    void* get_by_name(const Entity& entity, const std::string& name) {
+        return get_by_index(entity, Registry::index_of(name));
+    }
+    const void* get_by_name(const Entity& entity, const std::string& name) const {
+        return get_by_index(entity, Registry::index_of(name));
+    }
+
+    ///
+    /// @brief Remove the given components from the entity, leaving the entity and its other components alone. Any
+    /// components the entity doesn't have are ignored. This is constant time, the last component in each vector is
+    /// moved into the hole left behind.
+    ///
+    template <typename... C>
+    void remove(const Entity& entity) {
+        auto& proxy = lookup(entity);
+        (remove_impl<C>(proxy), ...);
+    }
+
+    ///
+    /// @brief Remove the given component from every entity which has it. This only visits the entities which have the
+    /// component.
+    ///
+    template <typename C>
+    void remove_all() {
+        constexpr size_t I = kIndexOf<C>;
+        auto& owners = owners_[I];
+        for (size_t owner : owners) entities_[owner].index[I] = kInvalidIndex;
+        owners.clear();
+        std::get<I>(components_).clear();
+    }
+
+    ///
+    /// @brief Dynamically remove a single component from the entity, does nothing if the entity doesn't have it
+    ///
+    void remove_by_index(const Entity& entity, size_t component_index) {
+        using Function = void (ComponentManager::*)(EntityProxy&);
+        static constexpr std::array<Function, kNumComponents> kFunctions{&ComponentManager::remove_impl<Component>...};
+        (this->*dynamic_lookup(kFunctions, component_index))(lookup(entity));
+    }
+    void remove_by_name(const Entity& entity, const std::string& name) {
+        remove_by_index(entity, Registry::index_of(name));
+    }
+
     ///
     /// @brief Does the given entity have the given components associated with it
     ///
@@ -141,29 +291,87 @@ public:
 
         // Clear the proxy
         proxy.empty = true;
+        proxy.freed = true;
         free_.push(proxy.id());
+        set_active_bit(proxy.id(), false);
 
         (remove_component_at<Component>(index[kIndexOf<Component>]), ...);
+        index.fill(kInvalidIndex);
+    }
+
+    ///
+    /// @brief Disable (put to sleep) or re-enable the given entity. Disabled entities keep all of their components but
+    /// are skipped by run_system(), so this is much cheaper than removing components or despawning. Entities are
+    /// enabled when spawned.
+    ///
+    void set_enabled(const Entity& entity, bool enabled) {
+        if (lookup(entity).empty) return;
+        set_active_bit(entity.id(), enabled);
+    }
+    void enable(const Entity& entity) { set_enabled(entity, true); }
+    void disable(const Entity& entity) { set_enabled(entity, false); }
+
+    bool is_enabled(const Entity& entity) const {
+        if (entity.id() >= entities_.size()) return false;
+        return active_bit(entity.id());
     }
 
     ///
-    /// @brief Execute the given function on entities with at least the given required components
+    /// @brief Execute the given function on enabled entities with at least the given required components. The name is
+    /// only used when profiling is enabled, see profiling.hh.
     ///
     template <typename... ReqComponent, typename System>
     void run_system(System&& system) {
-        for (const auto& proxy : entities_) {
-            if (proxy.empty || (!has_impl<ReqComponent>(proxy) || ...)) {
+        run_system<ReqComponent...>(SystemName{nullptr}, std::forward<System>(system));
+    }
+    template <typename... ReqComponent, typename System>
+    void run_system(SystemName name, System&& system) {
+        SystemProfileScope<kProfilingEnabled> scope{profiler_, name.value};
+
+        // Walk the active bits a word at a time so that despawned and disabled entities are skipped in bulk
+        for (size_t word = 0; word < active_.size(); ++word) {
+            for (uint64_t bits = active_[word]; bits != 0; bits &= bits - 1) {
+                const auto& proxy = entities_[kBitsPerWord * word + __builtin_ctzll(bits)];
+                scope.visit();
+                if ((!has_impl<ReqComponent>(proxy) || ...)) {
+                    continue;
+                }
+
+                scope.match();
+                if (run_system_and_check_stop<ReqComponent...>(system, proxy)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    ///
+    /// @brief Same as above, but only visits the given entities in the order they're provided (see SortedView for
+    /// example). Entities which are no longer alive, disabled or are missing a required component are skipped. The name
+    /// is only used when profiling is enabled.
+    ///
+    template <typename... ReqComponent, typename Entities, typename System>
+    void run_system(const Entities& entities, System&& system) {
+        run_system<ReqComponent...>(SystemName{nullptr}, entities, std::forward<System>(system));
+    }
+    template <typename... ReqComponent, typename Entities, typename System>
+    void run_system(SystemName name, const Entities& entities, System&& system) {
+        SystemProfileScope<kProfilingEnabled> scope{profiler_, name.value};
+
+        for (const Entity& entity : entities) {
+            scope.visit();
+            if (!is_enabled(entity)) {
                 continue;
             }
 
-            const auto run = [&]() { return run_system<ReqComponent...>(system, proxy); };
+            const auto& proxy = lookup(entity);
+            if ((!has_impl<ReqComponent>(proxy) || ...)) {
+                continue;
+            }
 
-            if constexpr (std::is_same_v<decltype(run()), bool>) {
-                if (run()) {
-                    break;
-                }
-            } else {
-                run();
+            scope.match();
+            if (run_system_and_check_stop<ReqComponent...>(system, proxy)) {
+                break;
             }
         }
     }
@@ -182,41 +390,204 @@ public:
         return !lookup(entity).empty;
     }
 
+    ///
+    /// @brief Report how much memory each component vector is using, along with the state of the entity free list.
+    /// This walks every entity so it's meant for debugging rather than calling every frame.
+    ///
+    ManagerStats stats() const {
+        ManagerStats stats;
+        stats.entities = entities_.size();
+        stats.alive = std::count_if(entities_.begin(), entities_.end(), [](const auto& proxy) { return !proxy.empty; });
+        stats.free = free_.size();
+        stats.fragmentation = stats.entities == 0 ? 0.0 : 1.0 - static_cast<double>(stats.alive) / stats.entities;
+        stats.bytes = entities_.capacity() * sizeof(EntityProxy) + active_.capacity() * sizeof(uint64_t) +
+                      free_.size() * sizeof(size_t);
+
+        const auto pool_stats = [&](const auto& components) {
+            using C = typename std::decay_t<decltype(components)>::value_type;
+            constexpr size_t I = kIndexOf<C>;
+
+            PoolStats pool;
+            pool.name = Registry::info(I).name;
+            pool.size = components.size();
+            pool.capacity = components.capacity();
+            pool.bytes = components.capacity() * sizeof(C) + owners_[I].capacity() * sizeof(size_t);
+            stats.bytes += pool.bytes;
+            stats.pools.push_back(std::move(pool));
+        };
+        std::apply([&](const auto&... components) { (pool_stats(components), ...); }, components_);
+
+        return stats;
+    }
+
+    ///
+    /// @brief Recorded run_system() calls, this will be empty unless profiling is enabled (see profiling.hh)
+    ///
+    const ManagerProfiler& profiler() const { return profiler_; }
+    ManagerProfiler& profiler() { return profiler_; }
+
+    ///
+    /// @brief Permute every component pool so that walking the entities in order also walks each pool front to back.
+    /// Swap-pop removals scramble the pools over time, this undoes that in a single pass over each pool.
+    ///
+    void sort_pools() {
+        std::vector<size_t> order(entities_.size());
+        std::iota(order.begin(), order.end(), 0);
+        (reorder_pool<Component>(order), ...);
+        reset_compaction();
+    }
+
+    ///
+    /// @brief Same as above, but the pools are laid out in ascending order of key(entity). This is useful for grouping
+    /// by archetype or spatial cell when iterating with raw_view(). Entities with equal keys keep their relative order.
+    ///
+    template <typename Key>
+    void sort_pools(Key&& key) {
+        using KeyType = std::decay_t<std::invoke_result_t<Key&, const Entity&>>;
+
+        std::vector<size_t> order;
+        std::vector<KeyType> keys;
+        order.reserve(entities_.size());
+        keys.reserve(entities_.size());
+        for (const auto& proxy : entities_) {
+            if (proxy.empty) continue;
+            order.push_back(proxy.id());
+            keys.push_back(key(static_cast<const Entity&>(proxy)));
+        }
+
+        // Sort indices into the keys vector so each key is only computed once
+        std::vector<size_t> sorted(order.size());
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::stable_sort(sorted.begin(), sorted.end(), [&](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
+        for (size_t& index : sorted) index = order[index];
+
+        (reorder_pool<Component>(sorted), ...);
+        reset_compaction();
+    }
+
+    ///
+    /// @brief Incremental version of sort_pools(), moving the components of at most max_entities entities per call so
+    /// the work can be spread over several frames. Structural changes between calls are safe, but may leave some
+    /// components out of order until the next pass.
+    /// @returns true when a full pass over the entities has completed (the next call will start a new pass)
+    ///
+    bool compact(size_t max_entities) {
+        for (size_t step = 0; step < max_entities && compact_cursor_ < entities_.size(); ++step) {
+            auto& proxy = entities_[compact_cursor_++];
+            if (proxy.empty) continue;
+            (compact_component<Component>(proxy), ...);
+        }
+
+        if (compact_cursor_ < entities_.size()) return false;
+        reset_compaction();
+        return true;
+    }
+
 private:
     template <typename C>
     static constexpr size_t kIndexOf = Index<C, Component...>::value;
 
     template <typename... ReqComponent, typename Function>
-    auto run_system(Function& system, const EntityProxy& proxy) {
+    auto invoke_system(Function& system, const EntityProxy& proxy) {
         std::tuple<const EntityProxy&, ReqComponent&...> args{
             proxy, std::get<kIndexOf<ReqComponent>>(components_)[proxy.index[kIndexOf<ReqComponent>]]...};
         return std::apply(system, args);
     }
 
-    template <typename... C>
-    Entity spawn_impl(C... c) {
-        EntityProxy* proxy;
-        if (free_.empty()) {
-            const size_t index = entities_.size();
-            proxy = &entities_.emplace_back(EntityProxy{index});
+    /// Systems can return true to stop iteration early, this handles both that and systems returning void
+    template <typename... ReqComponent, typename Function>
+    bool run_system_and_check_stop(Function& system, const EntityProxy& proxy) {
+        const auto run = [&]() { return invoke_system<ReqComponent...>(system, proxy); };
+
+        if constexpr (std::is_same_v<decltype(run()), bool>) {
+            return run();
         } else {
-            const size_t index = free_.front();
-            free_.pop();
-            proxy = &entities_[index];
-            proxy->reset();
+            run();
+            return false;
         }
+    }
+
+    template <typename... C>
+    Entity spawn_impl(C... c) {
+        EntityProxy& proxy = allocate();
+        proxy.reset();
+        set_active_bit(proxy.id(), true);
 
-        (add_impl<C>(proxy->index, std::move(c)), ...);
-        return *proxy;
+        (add_impl<C>(proxy, std::move(c)), ...);
+        return proxy;
+    }
+
+    /// Take an entity from the free list if possible, otherwise use a new id. The proxy still needs to be reset.
+    EntityProxy& allocate() {
+        if (free_.empty()) return proxy_for(next_id_.value.fetch_add(1, std::memory_order_relaxed));
+
+        const size_t index = free_.front();
+        free_.pop();
+        entities_[index].freed = false;
+        return entities_[index];
+    }
+
+    /// Make sure a proxy exists for the given id. Any ids skipped over were given out by reserve() and stay empty (but
+    /// off of the free list) until they're spawned.
+    EntityProxy& proxy_for(size_t id) {
+        while (entities_.size() <= id) entities_.emplace_back(EntityProxy{entities_.size()}).empty = true;
+        if (id / kBitsPerWord >= active_.size()) active_.resize(id / kBitsPerWord + 1, 0);
+        return entities_[id];
     }
 
     template <typename C>
-    void add_impl(EntityIndex& index, C c) {
+    void add_impl(EntityProxy& proxy, C c) {
+        constexpr size_t I = kIndexOf<C>;
+        auto& components = std::get<I>(components_);
+
+        // Adding a component that already exists just replaces the old value
+        if (has_impl<C>(proxy)) {
+            components[proxy.index[I]] = std::move(c);
+            return;
+        }
+
         // Set the index of each Component to the current size of the component vector
-        index[kIndexOf<C>] = std::get<kIndexOf<C>>(components_).size();
+        proxy.index[I] = components.size();
+        owners_[I].push_back(proxy.id());
 
         // Then actually add the new component to the appropriate element in the component vector
-        std::get<kIndexOf<C>>(components_).emplace_back(std::move(c));
+        components.emplace_back(std::move(c));
+    }
+
+    template <typename C>
+    void add_batch_impl(const std::vector<Entity>& entities, const C& c) {
+        constexpr size_t I = kIndexOf<C>;
+        auto& components = std::get<I>(components_);
+        auto& owners = owners_[I];
+
+        // These are all freshly spawned, so there is no need to check if the component already exists
+        const size_t start = components.size();
+        components.insert(components.end(), entities.size(), c);
+        owners.reserve(start + entities.size());
+        for (size_t i = 0; i < entities.size(); ++i) {
+            lookup(entities[i]).index[I] = start + i;
+            owners.push_back(entities[i].id());
+        }
+    }
+
+    template <typename C>
+    void add_default_impl(EntityProxy& proxy) {
+        if (!has_impl<C>(proxy)) add_impl(proxy, C{});
+    }
+
+    template <typename C>
+    void remove_impl(EntityProxy& proxy) {
+        remove_component_at<C>(proxy.index[kIndexOf<C>]);
+        proxy.index[kIndexOf<C>] = kInvalidIndex;
+    }
+
+    template <typename Function>
+    static Function dynamic_lookup(const std::array<Function, kNumComponents>& functions, size_t component_index) {
+        if (component_index >= kNumComponents) {
+            throw std::runtime_error("Component index " + std::to_string(component_index) +
+                                     " is out of range for this ComponentManager.");
+        }
+        return functions[component_index];
     }
 
     template <typename... C>
@@ -234,6 +605,15 @@ private:
         return has_impl<C>(proxy) ? &std::get<kIndexOf<C>>(components_).at(proxy.index[kIndexOf<C>]) : nullptr;
     }
 
+    template <typename C>
+    void* get_erased_impl(const EntityProxy& proxy) {
+        return get_ptr_impl<C>(proxy);
+    }
+    template <typename C>
+    const void* get_erased_impl(const EntityProxy& proxy) const {
+        return get_ptr_impl<C>(proxy);
+    }
+
     template <typename C>
     C& get_impl(const EntityProxy& proxy) {
         C* ptr = get_ptr_impl<C>(proxy);
@@ -263,16 +643,91 @@ private:
 
         constexpr size_t I = kIndexOf<C>;
         auto& vector = std::get<I>(components_);
+        auto& owners = owners_[I];
 
         // Replace the component at this index with the component at the end
         assert(vector.size() != 0);
         const size_t end_index = vector.size() - 1;
-        std::swap(vector[component_index], vector[end_index]);
+        if (component_index != end_index) {
+            vector[component_index] = std::move(vector[end_index]);
+            owners[component_index] = owners[end_index];
+
+            // Make sure to fix up the "dangling pointer" of the entity which owned the moved component
+            entities_[owners[component_index]].index[I] = component_index;
+        }
         vector.pop_back();
+        owners.pop_back();
+    }
+
+    template <typename C>
+    void reorder_pool(const std::vector<size_t>& order) {
+        constexpr size_t I = kIndexOf<C>;
+        auto& vector = std::get<I>(components_);
+        auto& owners = owners_[I];
 
-        // Make sure to fix up any "dangling pointers" after we removed the component index
-        for (auto& proxy : entities_)
-            if (proxy.index[I] == end_index) proxy.index[I] = component_index;
+        std::vector<C> sorted;
+        sorted.reserve(vector.size());
+        owners.clear();
+
+        for (size_t id : order) {
+            auto& proxy = entities_[id];
+            if (proxy.empty || !has_impl<C>(proxy)) continue;
+
+            size_t& index = proxy.index[I];
+            sorted.emplace_back(std::move(vector[index]));
+            index = owners.size();
+            owners.push_back(id);
+        }
+
+        assert(sorted.size() == vector.size());
+        vector = std::move(sorted);
+    }
+
+    template <typename C>
+    void compact_component(EntityProxy& proxy) {
+        constexpr size_t I = kIndexOf<C>;
+        if (!has_impl<C>(proxy)) return;
+
+        // Every entity visited earlier in this pass has already claimed the slots before this one
+        const size_t target = compact_slot_[I]++;
+        const size_t current = proxy.index[I];
+        if (target == current || target >= std::get<I>(components_).size()) return;
+
+        auto& vector = std::get<I>(components_);
+        auto& owners = owners_[I];
+        std::swap(vector[current], vector[target]);
+        std::swap(owners[current], owners[target]);
+        entities_[owners[current]].index[I] = current;
+        entities_[owners[target]].index[I] = target;
+    }
+
+    void set_active_bit(size_t id, bool active) {
+        const uint64_t mask = uint64_t{1} << (id % kBitsPerWord);
+        if (active)
+            active_[id / kBitsPerWord] |= mask;
+        else
+            active_[id / kBitsPerWord] &= ~mask;
+    }
+    bool active_bit(size_t id) const { return (active_[id / kBitsPerWord] >> (id % kBitsPerWord)) & 1; }
+
+    void reset_compaction() {
+        compact_cursor_ = 0;
+        compact_slot_.fill(0);
+    }
+
+    /// Recompute which entity owns each component slot and which entities are active, only needed when the entity
+    /// indices are set directly
+    void rebuild_bookkeeping() {
+        next_id_.value = entities_.size();
+        active_.assign((entities_.size() + kBitsPerWord - 1) / kBitsPerWord, 0);
+        (owners_[kIndexOf<Component>].assign(std::get<kIndexOf<Component>>(components_).size(), kInvalidIndex), ...);
+
+        for (const auto& proxy : entities_) {
+            if (proxy.empty) continue;
+            set_active_bit(proxy.id(), true);
+            for (size_t i = 0; i < kNumComponents; ++i)
+                if (proxy.index[i] != kInvalidIndex) owners_[i].at(proxy.index[i]) = proxy.id();
+        }
     }
 
     EntityProxy& lookup(const Entity& entity) { return entities_[entity.id()]; }
@@ -287,6 +742,35 @@ private:
 private:
     std::queue<size_t> free_;
     std::vector<EntityProxy> entities_;
+
+    // New entity ids are handed out from here (either by spawning or reserve()). std::atomic isn't copyable, so this is
+    // wrapped to keep the manager copyable.
+    struct AtomicId {
+        AtomicId() = default;
+        AtomicId(const AtomicId& rhs) : value(rhs.value.load()) {}
+        AtomicId& operator=(const AtomicId& rhs) {
+            value = rhs.value.load();
+            return *this;
+        }
+        std::atomic<size_t> value{0};
+    };
+    AtomicId next_id_;
+
+    // One bit per entity which is set if the entity is alive and enabled, this is what run_system() scans
+    static constexpr size_t kBitsPerWord = 64;
+    std::vector<uint64_t> active_;
+
     std::tuple<std::vector<Component>...> components_;
+
+    // For each component vector, the id of the entity which owns each element. This lets removals fix up indices
+    // without scanning every entity.
+    std::array<std::vector<size_t>, kNumComponents> owners_;
+
+    // An empty type unless profiling is enabled
+    ManagerProfiler profiler_;
+
+    // Progress of an incremental compact() pass
+    size_t compact_cursor_ = 0;
+    EntityIndex compact_slot_{};
 };
 }  // namespace ecs
@@ -11,6 +11,7 @@ Entity Entity::spawn_with(Entity::Id id) {
     counter_ = id + 1;
     return {id};
 }
+Entity Entity::from_id(Entity::Id id) { return {id}; }
 
 //
 // #############################################################################
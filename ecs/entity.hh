@@ -8,6 +8,9 @@ public:
     static Entity spawn();
     static Entity spawn_with(Id id);
 
+    /// Refer to an existing id, unlike spawn_with() this doesn't touch the counter so it's safe to call from any thread
+    static Entity from_id(Id id);
+
     const Id& id() const;
 
 private:
@@ -0,0 +1,51 @@
+#pragma once
+#include <tuple>
+#include <vector>
+
+#include "ecs/components.hh"
+#include "ecs/entity.hh"
+
+namespace ecs {
+
+///
+/// @brief A stored bundle of components which can be stamped out many times. Rather than constructing the components
+/// for each spawn, instantiate() copies the stored components into the manager in one batch.
+///
+/// Usage:
+///   Prefab enemy{Position{}, Health{100}, Sprite{"enemy"}};
+///   std::vector<Entity> wave = enemy.instantiate(manager, 5000);
+///
+template <typename... Component>
+class Prefab {
+public:
+    Prefab() = default;
+    Prefab(Component... components) : components_(std::move(components)...) {}
+
+    ///
+    /// @brief Access the stored component, changes will apply to future instantiations
+    ///
+    template <typename C>
+    C& get() {
+        return std::get<C>(components_);
+    }
+    template <typename C>
+    const C& get() const {
+        return std::get<C>(components_);
+    }
+
+    ///
+    /// @brief Spawn count entities in the manager, each with a copy of every component in the prefab
+    ///
+    template <typename... ManagerComponent>
+    std::vector<Entity> instantiate(ComponentManager<ManagerComponent...>& manager, size_t count) const {
+        return std::apply([&](const Component&... c) { return manager.spawn_batch(count, c...); }, components_);
+    }
+    template <typename... ManagerComponent>
+    Entity instantiate(ComponentManager<ManagerComponent...>& manager) const {
+        return std::apply([&](const Component&... c) { return manager.spawn(c...); }, components_);
+    }
+
+private:
+    std::tuple<Component...> components_;
+};
+}  // namespace ecs
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+///
+/// Instrumentation of ComponentManager::run_system() is opt-in, build with -DECS_PROFILING (or --config=ecs_profiling)
+/// to turn it on. When it's off the hooks compile away to nothing, and managers have no profiling state.
+///
+#ifdef ECS_PROFILING
+#define ECS_PROFILING_ENABLED true
+#else
+#define ECS_PROFILING_ENABLED false
+#endif
+
+namespace ecs {
+
+constexpr bool kProfilingEnabled = ECS_PROFILING_ENABLED;
+
+///
+/// @brief Name a system passed to ComponentManager::run_system() for profiling. This must outlive the manager, so
+/// string literals should be used.
+///
+struct SystemName {
+    const char* value;
+};
+
+///
+/// @brief A single run_system() call
+///
+struct SystemSample {
+    const char* name;
+    std::chrono::nanoseconds duration;
+
+    // How many entities were looked at, and how many of those had all the required components
+    size_t visited;
+    size_t matched;
+};
+
+///
+/// @brief Accumulated samples for each named system
+///
+struct SystemTotals {
+    size_t calls = 0;
+    std::chrono::nanoseconds duration{0};
+    size_t visited = 0;
+    size_t matched = 0;
+};
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Keeps the most recent samples in a ring buffer along with totals for each system name
+///
+class SystemProfiler {
+public:
+    static constexpr size_t kCapacity = 256;
+    static constexpr const char* kUnnamed = "<unnamed>";
+
+    void record(const SystemSample& sample) {
+        // Only allocate if something is actually recorded
+        if (samples_.empty()) samples_.resize(kCapacity);
+        samples_[next_++ % kCapacity] = sample;
+
+        auto& totals = totals_[sample.name];
+        totals.calls++;
+        totals.duration += sample.duration;
+        totals.visited += sample.visited;
+        totals.matched += sample.matched;
+    }
+
+    ///
+    /// @brief The most recent samples, ordered from oldest to newest
+    ///
+    std::vector<SystemSample> samples() const {
+        std::vector<SystemSample> result;
+        const size_t count = std::min(next_, kCapacity);
+        result.reserve(count);
+        for (size_t i = next_ - count; i < next_; ++i) result.push_back(samples_[i % kCapacity]);
+        return result;
+    }
+
+    const std::unordered_map<std::string_view, SystemTotals>& totals() const { return totals_; }
+
+    void clear() {
+        next_ = 0;
+        totals_.clear();
+    }
+
+private:
+    std::vector<SystemSample> samples_;
+    size_t next_ = 0;
+    std::unordered_map<std::string_view, SystemTotals> totals_;
+};
+
+///
+/// @brief Stands in for SystemProfiler when profiling is disabled, so managers don't carry any profiling state. It
+/// never has any samples.
+///
+class NullSystemProfiler {
+public:
+    std::vector<SystemSample> samples() const { return {}; }
+
+    const std::unordered_map<std::string_view, SystemTotals>& totals() const {
+        static const std::unordered_map<std::string_view, SystemTotals> kEmpty;
+        return kEmpty;
+    }
+
+    void clear() {}
+};
+
+///
+/// @brief The profiler each ComponentManager has
+///
+using ManagerProfiler = std::conditional_t<kProfilingEnabled, SystemProfiler, NullSystemProfiler>;
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Measures a single run_system() call, recording into the profiler when destroyed. The disabled version is
+/// empty so it's optimized out entirely.
+///
+template <bool Enabled = kProfilingEnabled>
+class SystemProfileScope {
+public:
+    SystemProfileScope(SystemProfiler& profiler, const char* name)
+        : profiler_(profiler), name_(name ? name : SystemProfiler::kUnnamed), start_(Clock::now()) {}
+    ~SystemProfileScope() { profiler_.record({name_, Clock::now() - start_, visited_, matched_}); }
+
+    void visit() { visited_++; }
+    void match() { matched_++; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    SystemProfiler& profiler_;
+    const char* name_;
+    Clock::time_point start_;
+    size_t visited_ = 0;
+    size_t matched_ = 0;
+};
+
+template <>
+class SystemProfileScope<false> {
+public:
+    SystemProfileScope(NullSystemProfiler&, const char*) {}
+    void visit() {}
+    void match() {}
+};
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Memory usage of a single component vector
+///
+struct PoolStats {
+    std::string name;
+    size_t size;
+    size_t capacity;
+
+    // Including the bookkeeping needed for each component
+    size_t bytes;
+};
+
+///
+/// @brief Memory usage of a ComponentManager, see ComponentManager::stats()
+///
+struct ManagerStats {
+    // Number of entity slots (alive, free and reserved)
+    size_t entities;
+    size_t alive;
+    size_t free;
+
+    // Fraction of entity slots which aren't alive
+    double fragmentation;
+
+    size_t bytes;
+    std::vector<PoolStats> pools;
+};
+}  // namespace ecs
@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "ecs/serializer.hh"
+
+namespace ecs {
+
+///
+/// @brief Type erased description of a component. This is what tools (editors, scripting, ...) can use to work with
+/// components without knowing their types at compile time.
+///
+struct ComponentInfo {
+    /// Either the name provided by the Serializer<> specialization, or the compiler's type name if there isn't one
+    std::string name;
+    size_t size;
+    size_t alignment;
+
+    /// Construct into uninitialized memory (at least size bytes with the given alignment)
+    void (*construct)(void* destination);
+    void (*copy)(void* destination, const void* source);
+    void (*move)(void* destination, void* source);
+
+    /// Destroy an object constructed with one of the above, without freeing the memory
+    void (*destroy)(void* object);
+
+    /// These will be null if there isn't a Serializer<> specialization for the component
+    std::string (*serialize)(const void* object);
+    void (*deserialize)(void* object, const std::string& serialized);
+};
+
+///
+/// @brief Get the (static) info for the given component
+///
+template <typename C>
+const ComponentInfo& component_info() {
+    static const ComponentInfo info = []() {
+        ComponentInfo info;
+        info.size = sizeof(C);
+        info.alignment = alignof(C);
+        info.construct = [](void* destination) { new (destination) C{}; };
+        info.copy = [](void* destination, const void* source) { new (destination) C(*static_cast<const C*>(source)); };
+        info.move = [](void* destination, void* source) { new (destination) C(std::move(*static_cast<C*>(source))); };
+        info.destroy = [](void* object) { static_cast<C*>(object)->~C(); };
+
+        if constexpr (kSerializerExists<C>) {
+            info.name = Serializer<C>{}.name();
+            info.serialize = [](const void* object) {
+                return Serializer<C>{}.serialize(*static_cast<const C*>(object));
+            };
+            info.deserialize = [](void* object, const std::string& serialized) {
+                *static_cast<C*>(object) = Serializer<C>{}.deserialize(serialized);
+            };
+        } else {
+            info.name = typeid(C).name();
+            info.serialize = nullptr;
+            info.deserialize = nullptr;
+        }
+        return info;
+    }();
+    return info;
+}
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Runtime lookup of the components in a ComponentManager, indices match the order of the template arguments.
+///
+template <typename... Component>
+class ComponentRegistry {
+public:
+    static constexpr size_t kNumComponents = sizeof...(Component);
+
+    static const ComponentInfo& info(size_t index) {
+        static const std::array<const ComponentInfo*, kNumComponents> infos{&component_info<Component>()...};
+        if (index >= kNumComponents) {
+            throw std::runtime_error("ComponentRegistry::info() index " + std::to_string(index) + " out of range.");
+        }
+        return *infos[index];
+    }
+
+    static std::optional<size_t> find(const std::string& name) {
+        static const std::unordered_map<std::string, size_t> indices = []() {
+            std::unordered_map<std::string, size_t> indices;
+            for (size_t i = 0; i < kNumComponents; ++i) indices.emplace(info(i).name, i);
+            return indices;
+        }();
+
+        auto it = indices.find(name);
+        if (it == indices.end()) return std::nullopt;
+        return it->second;
+    }
+
+    static size_t index_of(const std::string& name) {
+        if (auto index = find(name)) return *index;
+        throw std::runtime_error("ComponentRegistry has no component named '" + name + "'");
+    }
+};
+}  // namespace ecs
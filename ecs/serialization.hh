@@ -5,6 +5,8 @@
 #include <string>
 
 #include "ecs/components.hh"
+#include "ecs/prefab.hh"
+#include "ecs/serializer.hh"
 #include "ecs/utils.hh"
 #include "yaml-cpp/yaml.h"
 
@@ -13,11 +15,14 @@
 /// looks roughly like:
 ///
 /// entities:
-///   - []
-///   - [-1, -1, 3]
-///   - [-1, -1, 4]
+///   - index: []
+///   - index: [-1, -1, 3]
+///   - index: [-1, -1, 4]
+///     enabled: false
 ///   ...
 ///
+/// Disabled entities store enabled: false, it's left out for everything else.
+///
 /// components:
 ///   - name: "c0"
 ///     values: [{...}, {...}, ...]
@@ -26,26 +31,19 @@
 ///   - name: "c2"
 ///     values: [{...}, {...}, ...]
 ///
-
+/// Prefabs use the same component names, but only store a single value for each component:
 ///
-/// @brief Strict that needs to be specialized for each component for serialization to work
+/// components:
+///   - name: "c0"
+///     data: "{...}"
+///   ...
 ///
-template <typename T>
-struct Serializer {
-    virtual std::string name() const = 0;
-    virtual std::string serialize(const T&) const = 0;
-    virtual T deserialize(const std::string&) const = 0;
-};
-
-//
-// #############################################################################
-//
 
 namespace ecs {
 struct CompomentSerializer {
     /// Does a specialized serializer exist for the given component?
     template <typename C>
-    static constexpr bool kExists = !std::is_abstract_v<Serializer<C>>;
+    static constexpr bool kExists = kSerializerExists<C>;
 
     template <typename Component>
     std::enable_if_t<kExists<Component>> serialize(const std::vector<Component>& vector) {
@@ -127,6 +125,7 @@ std::string serialize(const ComponentManager<Component...>& manager) {
         for (auto i : proxy.index) data.push_back(i == Manager::kInvalidIndex ? -1 : i);
         entity["index"] = proxy.empty ? std::vector<int>() : data;
         entity["index"].SetStyle(YAML::EmitterStyle::Flow);
+        if (!proxy.empty && !manager.active_bit(proxy.id())) entity["enabled"] = false;
         result["entities"].push_back(entity);
     }
 
@@ -156,12 +155,14 @@ void deserialize(const std::string& serialized, ComponentManager<Component...>&
     const auto& entities = root["entities"];
     const auto& components = root["components"];
 
+    std::vector<size_t> disabled;
     for (size_t i = 0; i < entities.size(); ++i) {
         std::vector<int> data = entities[i]["index"].as<std::vector<int>>();
         auto& proxy = output.entities_.emplace_back(i);
 
         proxy.empty = data.empty();
         if (proxy.empty) {
+            proxy.freed = true;
             output.free_.push(i);
             proxy.index.fill(static_cast<size_t>(-1));
             continue;
@@ -173,11 +174,65 @@ void deserialize(const std::string& serialized, ComponentManager<Component...>&
                 "components added to the ComponentManager since saving?");
 
         for (size_t index = 0; index < data.size(); ++index) proxy.index[index] = static_cast<size_t>(data[index]);
+        if (entities[i]["enabled"] && !entities[i]["enabled"].as<bool>()) disabled.push_back(i);
     }
 
     CompomentSerializer serializer{components};
     std::apply([&](std::vector<Component>&... component) { (serializer.deserialize(component), ...); },
                output.components_);
+    output.rebuild_bookkeeping();
+
+    // Rebuilding marks every alive entity as enabled
+    for (size_t id : disabled) output.set_active_bit(id, false);
+}
+
+//
+// #############################################################################
+//
+template <typename... Component>
+std::string serialize(const Prefab<Component...>& prefab) {
+    (CompomentSerializer::assert_serializer_exists<Component>(), ...);
+
+    YAML::Node result;
+    const auto serialize_component = [&](const auto& c) {
+        Serializer<std::decay_t<decltype(c)>> s;
+        YAML::Node component;
+        component["name"] = s.name();
+        component["data"] = s.serialize(c);
+        result["components"].push_back(component);
+    };
+    (serialize_component(prefab.template get<Component>()), ...);
+
+    std::stringstream ss;
+    ss << result;
+    return ss.str();
+}
+
+//
+// #############################################################################
+//
+
+template <typename... Component>
+void deserialize(const std::string& serialized, Prefab<Component...>& output) {
+    (CompomentSerializer::assert_serializer_exists<Component>(), ...);
+
+    const auto root = YAML::Load(serialized);
+    const auto& components = root["components"];
+
+    const auto deserialize_component = [&](auto& c) {
+        Serializer<std::decay_t<decltype(c)>> s;
+        const std::string name = s.name();
+        for (const auto& node : components) {
+            if (node["name"].as<std::string>() != name) {
+                continue;
+            }
+
+            c = s.deserialize(node["data"].as<std::string>());
+            return;
+        }
+        throw std::runtime_error("Unable to find '" + name + "' component in the serialized prefab.");
+    };
+    (deserialize_component(output.template get<Component>()), ...);
 }
 
 //
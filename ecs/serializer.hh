@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <type_traits>
+
+///
+/// @brief Strict that needs to be specialized for each component for serialization to work
+///
+template <typename T>
+struct Serializer {
+    virtual std::string name() const = 0;
+    virtual std::string serialize(const T&) const = 0;
+    virtual T deserialize(const std::string&) const = 0;
+};
+
+namespace ecs {
+/// Has a Serializer been specialized for the given component?
+template <typename C>
+constexpr bool kSerializerExists = !std::is_abstract_v<Serializer<C>>;
+}  // namespace ecs
@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "ecs/entity.hh"
+
+namespace ecs {
+
+///
+/// @brief Keeps the entities which have a given component sorted by a user defined key of that component. Useful for
+/// things like drawing sprites in layer order. Since keys usually don't change much between frames, update() only
+/// re-sorts the entries which are out of place and merges them back in, which is near linear when few keys change.
+///
+/// Usage:
+///   auto view = make_sorted_view<Sprite>([](const Sprite& s) { return std::make_pair(s.layer, -s.y); });
+///   view.update(manager);
+///   manager.run_system<Sprite, Position>(view, [](const Entity&, Sprite&, Position&) { ... });
+///
+template <typename C, typename KeyFunction>
+class SortedView {
+public:
+    using Key = std::decay_t<std::invoke_result_t<KeyFunction&, const C&>>;
+
+    ///
+    /// @brief Each entry is convertible to the entity it refers to, so the view can be passed to run_system() directly
+    ///
+    struct Entry : Entity {
+        Entry(const Entity& entity, Key key) : Entity(entity), key(std::move(key)) {}
+        Key key;
+    };
+    using const_iterator = typename std::vector<Entry>::const_iterator;
+
+public:
+    SortedView(KeyFunction key_function) : key_function_(std::move(key_function)) {}
+
+    ///
+    /// @brief Refresh the keys of every entity with the component, add new entities, drop removed ones and re-sort
+    ///
+    template <typename Manager>
+    void update(Manager& manager) {
+        ++generation_;
+        std::vector<Entry> added;
+
+        manager.template run_system<C>([&](const Entity& entity, const C& component) {
+            const Entity::Id id = entity.id();
+            if (id >= positions_.size()) {
+                positions_.resize(id + 1, kNotPresent);
+                seen_.resize(id + 1, 0);
+            }
+            seen_[id] = generation_;
+
+            if (positions_[id] == kNotPresent) {
+                added.emplace_back(entity, key_function_(component));
+            } else {
+                entries_[positions_[id]].key = key_function_(component);
+            }
+        });
+
+        // Keep entries which are alive and are still in order with both neighbors, everything else gets re-inserted
+        std::vector<Entry> dirty = std::move(added);
+        size_t kept = 0;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            Entry& entry = entries_[i];
+            const Entity::Id id = entry.id();
+            if (seen_[id] != generation_) {
+                positions_[id] = kNotPresent;
+                continue;
+            }
+
+            const bool after_previous = kept == 0 || !(entry.key < entries_[kept - 1].key);
+            const bool before_next = i + 1 == entries_.size() || !(entries_[i + 1].key < entry.key);
+            if (after_previous && before_next) {
+                if (kept != i) entries_[kept] = std::move(entry);
+                kept++;
+            } else {
+                dirty.emplace_back(std::move(entry));
+            }
+        }
+        entries_.erase(entries_.begin() + kept, entries_.end());
+
+        if (!dirty.empty()) {
+            const auto compare = [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; };
+            std::stable_sort(dirty.begin(), dirty.end(), compare);
+
+            entries_.reserve(entries_.size() + dirty.size());
+            std::move(dirty.begin(), dirty.end(), std::back_inserter(entries_));
+            std::inplace_merge(entries_.begin(), entries_.begin() + kept, entries_.end(), compare);
+        }
+
+        for (size_t i = 0; i < entries_.size(); ++i) positions_[entries_[i].id()] = i;
+    }
+
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    size_t size() const { return entries_.size(); }
+
+private:
+    static constexpr size_t kNotPresent = -1;
+
+    KeyFunction key_function_;
+
+    std::vector<Entry> entries_;
+
+    // Indexed by entity id, where the entity is in entries_ and which update() it was last seen during
+    std::vector<size_t> positions_;
+    std::vector<uint32_t> seen_;
+    uint32_t generation_ = 0;
+};
+
+template <typename C, typename KeyFunction>
+SortedView<C, KeyFunction> make_sorted_view(KeyFunction key_function) {
+    return {std::move(key_function)};
+}
+}  // namespace ecs
@@ -0,0 +1,69 @@
+#pragma once
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ecs/components.hh"
+#include "ecs/entity.hh"
+
+namespace ecs {
+
+///
+/// @brief Per-thread staging area for spawning entities from worker threads. Each worker owns its own buffer, so
+/// spawning only needs the (lock free) ComponentManager::reserve(). The entities are created when the buffer is merged
+/// into the manager at a sync point on the thread which owns the manager.
+///
+/// Usage:
+///   // On each worker
+///   SpawnBuffer buffer{manager};
+///   Entity bullet = buffer.spawn(Position{...}, Velocity{...});
+///
+///   // Back on the main thread, once the workers are done
+///   buffer.merge();
+///
+template <typename... Component>
+class SpawnBuffer {
+public:
+    using Manager = ComponentManager<Component...>;
+
+    SpawnBuffer(Manager& manager) : manager_(manager) {}
+
+    ///
+    /// @brief Spawn an entity with the given components. The entity will be alive after the next merge()
+    ///
+    template <typename... C>
+    Entity spawn(C... c) {
+        Entity entity = manager_.reserve();
+        spawned_.push_back(entity);
+        (std::get<Staged<C>>(staged_).emplace_back(entity, std::move(c)), ...);
+        return entity;
+    }
+
+    ///
+    /// @brief Create all of the staged entities in the manager and clear the buffer. This isn't thread safe, it should
+    /// be called from the thread which owns the manager while no other thread is using it.
+    ///
+    void merge() {
+        for (const Entity& entity : spawned_) manager_.spawn_reserved(entity);
+        (merge_components<Component>(), ...);
+        spawned_.clear();
+    }
+
+    size_t size() const { return spawned_.size(); }
+
+private:
+    template <typename C>
+    using Staged = std::vector<std::pair<Entity, C>>;
+
+    template <typename C>
+    void merge_components() {
+        auto& staged = std::get<Staged<C>>(staged_);
+        for (auto& [entity, component] : staged) manager_.add(entity, std::move(component));
+        staged.clear();
+    }
+
+    Manager& manager_;
+    std::vector<Entity> spawned_;
+    std::tuple<Staged<Component>...> staged_;
+};
+}  // namespace ecs
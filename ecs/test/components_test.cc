@@ -210,4 +210,215 @@ TEST(ComponentManager, const_access) {
         EXPECT_TRUE(ab);
     }
 }
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, sort_pools) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 10; ++i) entities.push_back(manager.spawn(TestComponentA{i}, TestComponentC{i % 2 == 0}));
+
+    // Scramble the pools with some swap-pop removals
+    manager.despawn(entities[1]);
+    manager.despawn(entities[4]);
+    entities.push_back(manager.spawn(TestComponentA{100}));
+    manager.add(entities[2], TestComponentB{"two"});
+    manager.add(entities[0], TestComponentB{"zero"});
+
+    manager.sort_pools();
+
+    // Walking the entities in order should now walk the pool in order too
+    const auto [a, size] = manager.raw_view<TestComponentA>();
+    ASSERT_EQ(size, 9);
+    size_t index = 0;
+    manager.run_system<TestComponentA>([&](const Entity&, const TestComponentA& component) {
+        EXPECT_EQ(&component, a + index++);
+    });
+
+    const auto [b, b_size] = manager.raw_view<TestComponentB>();
+    ASSERT_EQ(b_size, 2);
+    EXPECT_EQ(b[0].value, "zero");
+    EXPECT_EQ(b[1].value, "two");
+
+    // Lookups still find the correct data
+    EXPECT_EQ(manager.get<TestComponentA>(entities[2]).value, 2);
+    EXPECT_EQ(manager.get<TestComponentA>(entities[9]).value, 9);
+    EXPECT_TRUE(manager.get<TestComponentC>(entities[8]).set);
+    EXPECT_FALSE(manager.get<TestComponentC>(entities[7]).set);
+
+    // And removals after sorting still work
+    manager.despawn(entities[0]);
+    EXPECT_EQ(manager.get<TestComponentB>(entities[2]).value, "two");
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, sort_pools_by_key) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 10; ++i) entities.push_back(manager.spawn(TestComponentA{i}));
+
+    // Reverse order
+    manager.sort_pools([&](const Entity& entity) { return -manager.get<TestComponentA>(entity).value; });
+
+    const auto [a, size] = manager.raw_view<TestComponentA>();
+    ASSERT_EQ(size, 10);
+    for (size_t i = 0; i < size; ++i) EXPECT_EQ(a[i].value, 9 - static_cast<int>(i));
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(manager.get<TestComponentA>(entities[i]).value, i);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, compact) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 20; ++i) entities.push_back(manager.spawn(TestComponentA{i}));
+    for (int i = 0; i < 20; i += 3) manager.despawn(entities[i]);
+
+    // One entity per step, so this should take a few calls
+    size_t calls = 1;
+    while (!manager.compact(1)) calls++;
+    EXPECT_EQ(calls, 20);
+
+    const auto [a, size] = manager.raw_view<TestComponentA>();
+    int previous = -1;
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_GT(a[i].value, previous);
+        previous = a[i].value;
+    }
+    for (int i = 0; i < 20; ++i) {
+        if (manager.is_alive(entities[i])) {
+            EXPECT_EQ(manager.get<TestComponentA>(entities[i]).value, i);
+        }
+    }
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, enable_disable) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 200; ++i) entities.push_back(manager.spawn(TestComponentA{i}));
+
+    // Disable everything except for a few entities spread across multiple words
+    for (int i = 0; i < 200; ++i) {
+        if (i != 3 && i != 64 && i != 150) manager.disable(entities[i]);
+    }
+    EXPECT_FALSE(manager.is_enabled(entities[0]));
+    EXPECT_TRUE(manager.is_enabled(entities[64]));
+    EXPECT_TRUE(manager.is_alive(entities[0]));
+
+    std::vector<int> visited;
+    manager.run_system<TestComponentA>([&](const Entity&, TestComponentA& a) { visited.push_back(a.value); });
+    EXPECT_EQ(visited, (std::vector<int>{3, 64, 150}));
+
+    // Components are still accessible while sleeping, and come back instantly
+    EXPECT_EQ(manager.get<TestComponentA>(entities[10]).value, 10);
+    manager.enable(entities[10]);
+    manager.despawn(entities[64]);
+    EXPECT_FALSE(manager.is_enabled(entities[64]));
+
+    visited.clear();
+    manager.run_system<TestComponentA>([&](const Entity&, TestComponentA& a) { visited.push_back(a.value); });
+    EXPECT_EQ(visited, (std::vector<int>{3, 10, 150}));
+
+    // Respawning into the freed slot should be enabled again
+    auto respawned = manager.spawn(TestComponentA{1000});
+    EXPECT_TRUE(manager.is_enabled(respawned));
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, stats) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 10; ++i) entities.push_back(manager.spawn(TestComponentA{i}));
+    manager.add<TestComponentB>(entities[0]);
+    manager.despawn(entities[3]);
+    manager.despawn(entities[4]);
+
+    const ManagerStats stats = manager.stats();
+    EXPECT_EQ(stats.entities, 10);
+    EXPECT_EQ(stats.alive, 8);
+    EXPECT_EQ(stats.free, 2);
+    EXPECT_DOUBLE_EQ(stats.fragmentation, 0.2);
+
+    ASSERT_EQ(stats.pools.size(), 3);
+    EXPECT_EQ(stats.pools[0].size, 8);
+    EXPECT_GE(stats.pools[0].capacity, 8);
+    EXPECT_GE(stats.pools[0].bytes, 8 * sizeof(TestComponentA));
+    EXPECT_EQ(stats.pools[1].size, 1);
+    EXPECT_EQ(stats.pools[2].size, 0);
+    EXPECT_GT(stats.bytes, stats.pools[0].bytes + stats.pools[1].bytes);
+
+    // Samples are only recorded when built with --config=ecs_profiling
+    manager.run_system<TestComponentA>(SystemName{"named"}, [](const Entity&, TestComponentA&) {});
+    EXPECT_EQ(manager.profiler().samples().size(), kProfilingEnabled ? 1 : 0);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, remove) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 5; ++i) {
+        entities.push_back(manager.spawn(TestComponentA{i}, TestComponentB{std::to_string(i)}, TestComponentC{true}));
+    }
+
+    manager.remove<TestComponentC>(entities[1]);
+    manager.remove<TestComponentA, TestComponentB>(entities[2]);
+    manager.remove<TestComponentB>(entities[2]);  // already removed, no-op
+
+    EXPECT_TRUE(manager.is_alive(entities[1]));
+    EXPECT_FALSE(manager.has<TestComponentC>(entities[1]));
+    EXPECT_TRUE((manager.has<TestComponentA, TestComponentB>(entities[1])));
+    EXPECT_FALSE(manager.has<TestComponentA>(entities[2]));
+    EXPECT_TRUE(manager.has<TestComponentC>(entities[2]));
+
+    // The other entities should still point at the right data after the swaps
+    for (int i : {0, 1, 3, 4}) {
+        EXPECT_EQ(manager.get<TestComponentA>(entities[i]).value, i);
+        EXPECT_EQ(manager.get<TestComponentB>(entities[i]).value, std::to_string(i));
+    }
+
+    // Handles stay valid, so the component can be added again
+    manager.add(entities[2], TestComponentA{200});
+    EXPECT_EQ(manager.get<TestComponentA>(entities[2]).value, 200);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, remove_all) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 5; ++i) entities.push_back(manager.spawn(TestComponentA{i}));
+    manager.add<TestComponentC>(entities[1]);
+    manager.add<TestComponentC>(entities[3]);
+
+    manager.remove_all<TestComponentC>();
+
+    size_t count = 0;
+    manager.run_system<TestComponentC>([&](const Entity&, TestComponentC&) { count++; });
+    EXPECT_EQ(count, 0);
+    EXPECT_EQ(manager.raw_view<TestComponentC>().second, 0);
+    EXPECT_EQ(manager.get<TestComponentA>(entities[3]).value, 3);
+
+    manager.add<TestComponentC>(entities[4]);
+    EXPECT_TRUE(manager.has<TestComponentC>(entities[4]));
+    EXPECT_FALSE(manager.has<TestComponentC>(entities[1]));
+}
 }  // namespace ecs
@@ -0,0 +1,79 @@
+#include "ecs/prefab.hh"
+
+#include <gtest/gtest.h>
+
+namespace ecs {
+namespace {
+// Other tests use the same names, so keep these local to this file
+struct Position {
+    float x = 0.0;
+    float y = 0.0;
+};
+struct Health {
+    int value = 100;
+};
+struct Name {
+    std::string value;
+};
+
+using MyManager = ComponentManager<Position, Health, Name>;
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(Prefab, instantiate) {
+    MyManager manager;
+    Prefab enemy{Position{1.0, 2.0}, Health{50}};
+
+    auto single = enemy.instantiate(manager);
+    EXPECT_EQ(manager.get<Health>(single).value, 50);
+
+    std::vector<Entity> wave = enemy.instantiate(manager, 1000);
+    ASSERT_EQ(wave.size(), 1000);
+
+    size_t count = 0;
+    manager.run_system<Position, Health>([&](const Entity&, const Position& p, const Health& h) {
+        EXPECT_EQ(p.x, 1.0);
+        EXPECT_EQ(p.y, 2.0);
+        EXPECT_EQ(h.value, 50);
+        count++;
+    });
+    EXPECT_EQ(count, 1001);
+    EXPECT_FALSE(manager.has<Name>(wave.back()));
+
+    // Each instance is independent
+    manager.get<Health>(wave[10]).value = 0;
+    EXPECT_EQ(manager.get<Health>(wave[11]).value, 50);
+    manager.despawn(wave[10]);
+    EXPECT_EQ(manager.get<Health>(wave[999]).value, 50);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Prefab, reuse_despawned) {
+    MyManager manager;
+    std::vector<Entity> initial;
+    for (int i = 0; i < 5; ++i) initial.push_back(manager.spawn(Health{i}));
+    manager.despawn(initial[1]);
+    manager.despawn(initial[3]);
+
+    Prefab named{Name{"named"}};
+    named.get<Name>().value = "renamed";
+    std::vector<Entity> spawned = named.instantiate(manager, 4);
+    ASSERT_EQ(spawned.size(), 4);
+
+    // The two free slots should be reused before any new entities are created
+    EXPECT_EQ(spawned[0].id(), initial[1].id());
+    EXPECT_EQ(spawned[1].id(), initial[3].id());
+    for (const auto& entity : spawned) {
+        EXPECT_TRUE(manager.is_enabled(entity));
+        EXPECT_FALSE(manager.has<Health>(entity));
+        EXPECT_EQ(manager.get<Name>(entity).value, "renamed");
+    }
+    EXPECT_EQ(manager.get<Health>(initial[4]).value, 4);
+}
+}  // namespace ecs
@@ -0,0 +1,106 @@
+#include "ecs/profiling.hh"
+
+#include <gtest/gtest.h>
+
+#include "ecs/components.hh"
+
+namespace ecs {
+namespace {
+struct ProfiledA {
+    int value = 0;
+};
+struct ProfiledB {};
+
+using ProfiledManager = ComponentManager<ProfiledA, ProfiledB>;
+}  // namespace
+
+//
+// #############################################################################
+//
+
+// The hooks are only compiled in with --config=ecs_profiling
+#ifdef ECS_PROFILING
+TEST(Profiling, run_system) {
+    ProfiledManager manager;
+    for (int i = 0; i < 10; ++i) manager.spawn(ProfiledA{i});
+    for (int i = 0; i < 5; ++i) manager.spawn(ProfiledA{i}, ProfiledB{});
+
+    for (int i = 0; i < 3; ++i) {
+        manager.run_system<ProfiledA>(SystemName{"increment"}, [](const Entity&, ProfiledA& a) { a.value++; });
+    }
+    manager.run_system<ProfiledA, ProfiledB>([](const Entity&, ProfiledA&, ProfiledB&) {});
+
+    const auto& totals = manager.profiler().totals();
+    ASSERT_EQ(totals.size(), 2);
+
+    const SystemTotals& increment = totals.at("increment");
+    EXPECT_EQ(increment.calls, 3);
+    EXPECT_EQ(increment.visited, 3 * 15);
+    EXPECT_EQ(increment.matched, 3 * 15);
+
+    const SystemTotals& unnamed = totals.at(SystemProfiler::kUnnamed);
+    EXPECT_EQ(unnamed.calls, 1);
+    EXPECT_EQ(unnamed.visited, 15);
+    EXPECT_EQ(unnamed.matched, 5);
+
+    const auto samples = manager.profiler().samples();
+    ASSERT_EQ(samples.size(), 4);
+    EXPECT_STREQ(samples.front().name, "increment");
+    EXPECT_STREQ(samples.back().name, SystemProfiler::kUnnamed);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Profiling, run_system_ordered) {
+    ProfiledManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 4; ++i) entities.push_back(manager.spawn(ProfiledA{i}));
+    manager.add(entities[1], ProfiledB{});
+
+    manager.run_system<ProfiledA, ProfiledB>(SystemName{"ordered"}, entities,
+                                             [](const Entity&, ProfiledA&, ProfiledB&) {});
+
+    const SystemTotals& ordered = manager.profiler().totals().at("ordered");
+    EXPECT_EQ(ordered.calls, 1);
+    EXPECT_EQ(ordered.visited, 4);
+    EXPECT_EQ(ordered.matched, 1);
+}
+#endif
+
+//
+// #############################################################################
+//
+
+TEST(Profiling, ring_buffer) {
+    SystemProfiler profiler;
+
+    const size_t calls = SystemProfiler::kCapacity + 10;
+    for (size_t i = 0; i < calls; ++i) profiler.record(SystemSample{"a", std::chrono::nanoseconds(i), i, 0});
+
+    // Only the newest samples are kept, in order
+    const auto samples = profiler.samples();
+    ASSERT_EQ(samples.size(), SystemProfiler::kCapacity);
+    EXPECT_EQ(samples.front().visited, calls - SystemProfiler::kCapacity);
+    EXPECT_EQ(samples.back().visited, calls - 1);
+    EXPECT_EQ(profiler.totals().at("a").calls, calls);
+
+    profiler.clear();
+    EXPECT_TRUE(profiler.samples().empty());
+}
+
+//
+// #############################################################################
+//
+
+TEST(Profiling, enabled) {
+    ProfiledManager manager;
+    manager.spawn(ProfiledA{});
+    manager.run_system<ProfiledA>(SystemName{"a"}, [](const Entity&, ProfiledA&) {});
+
+    // Nothing is recorded unless profiling is compiled in, and then managers don't hold any profiling state at all
+    EXPECT_EQ(manager.profiler().samples().size(), kProfilingEnabled ? 1 : 0);
+    EXPECT_EQ(std::is_empty_v<ManagerProfiler>, !kProfilingEnabled);
+}
+}  // namespace ecs
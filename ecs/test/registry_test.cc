@@ -0,0 +1,108 @@
+#include "ecs/registry.hh"
+
+#include <gtest/gtest.h>
+
+#include "ecs/components.hh"
+
+namespace ecs {
+namespace {
+// Other tests use the same names, so keep these local to this file
+struct Position {
+    float x = 1.0;
+    float y = 2.0;
+};
+struct Name {
+    std::string value = "default";
+};
+
+using MyManager = ComponentManager<Position, Name>;
+}  // namespace
+}  // namespace ecs
+
+template <>
+struct Serializer<ecs::Name> {
+    virtual std::string name() const { return "name"; }
+    virtual std::string serialize(const ecs::Name& n) const { return n.value; };
+    virtual ecs::Name deserialize(const std::string& s) const { return ecs::Name{s}; };
+};
+
+//
+// #############################################################################
+//
+
+namespace ecs {
+
+TEST(ComponentRegistry, info) {
+    using Registry = MyManager::Registry;
+
+    const ComponentInfo& name = Registry::info(1);
+    EXPECT_EQ(name.name, "name");
+    EXPECT_EQ(name.size, sizeof(Name));
+    EXPECT_EQ(name.alignment, alignof(Name));
+    ASSERT_NE(name.serialize, nullptr);
+
+    // No serializer, so it falls back to the type name
+    const ComponentInfo& position = Registry::info(0);
+    EXPECT_EQ(position.name, typeid(Position).name());
+    EXPECT_EQ(position.serialize, nullptr);
+
+    EXPECT_EQ(Registry::index_of("name"), 1);
+    EXPECT_FALSE(Registry::find("not a component"));
+    EXPECT_THROW(Registry::index_of("not a component"), std::runtime_error);
+    EXPECT_THROW(Registry::info(2), std::runtime_error);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentRegistry, type_erased_functions) {
+    const ComponentInfo& info = component_info<Name>();
+
+    alignas(Name) unsigned char a[sizeof(Name)];
+    alignas(Name) unsigned char b[sizeof(Name)];
+    info.construct(a);
+    EXPECT_EQ(reinterpret_cast<Name*>(a)->value, "default");
+
+    info.deserialize(a, "loaded");
+    info.copy(b, a);
+    EXPECT_EQ(info.serialize(b), "loaded");
+    info.destroy(b);
+
+    info.move(b, a);
+    EXPECT_EQ(reinterpret_cast<Name*>(b)->value, "loaded");
+    info.destroy(a);
+    info.destroy(b);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ComponentManager, dynamic_access) {
+    MyManager manager;
+    auto entity = manager.spawn(Position{5.0, 6.0});
+
+    EXPECT_EQ(manager.get_by_name(entity, "name"), nullptr);
+    manager.add_by_name(entity, "name");
+    ASSERT_TRUE(manager.has<Name>(entity));
+
+    auto* name = static_cast<Name*>(manager.get_by_index(entity, 1));
+    ASSERT_NE(name, nullptr);
+    EXPECT_EQ(name->value, "default");
+    EXPECT_EQ(name, &manager.get<Name>(entity));
+
+    const MyManager& const_manager = manager;
+    const auto* position = static_cast<const Position*>(const_manager.get_by_index(entity, 0));
+    ASSERT_NE(position, nullptr);
+    EXPECT_EQ(position->x, 5.0);
+
+    manager.remove_by_index(entity, 0);
+    EXPECT_FALSE(manager.has<Position>(entity));
+    EXPECT_EQ(manager.get_by_index(entity, 0), nullptr);
+    manager.remove_by_name(entity, "name");
+    EXPECT_FALSE(manager.has<Name>(entity));
+
+    EXPECT_THROW(manager.add_by_index(entity, 2), std::runtime_error);
+}
+}  // namespace ecs
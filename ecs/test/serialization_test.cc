@@ -96,4 +96,54 @@ TEST_F(SerializationFixture, basic_deserialize) {
     ecs::deserialize(s, deserialized);
     ASSERT_NO_FATAL_FAILURE(validate(ecs::serialize(deserialized)));
 }
+
+//
+// #############################################################################
+//
+
+TEST_F(SerializationFixture, disabled_round_trip) {
+    Entity sleeping = manager.spawn(TestComponentA{5});
+    manager.disable(sleeping);
+
+    MyManager deserialized;
+    ecs::deserialize(ecs::serialize(manager), deserialized);
+
+    EXPECT_FALSE(deserialized.is_enabled(sleeping));
+    EXPECT_TRUE(deserialized.is_enabled(Entity::from_id(0)));
+
+    // Disabled entities are still skipped by systems
+    size_t visited = 0;
+    deserialized.run_system<TestComponentA>([&](const Entity&, TestComponentA&) { visited++; });
+    EXPECT_EQ(visited, 2);
+
+    deserialized.enable(sleeping);
+    EXPECT_EQ(deserialized.get<TestComponentA>(sleeping).value, 5);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Prefab, serialize_round_trip) {
+    Prefab<TestComponentA, TestComponentB> prefab{TestComponentA{5}, TestComponentB{"enemy"}};
+
+    const std::string s = ecs::serialize(prefab);
+    const YAML::Node result = YAML::Load(s);
+    ASSERT_EQ(result["components"].size(), 2);
+    EXPECT_EQ(result["components"][0]["name"].as<std::string>(), "A");
+    EXPECT_EQ(result["components"][0]["data"].as<std::string>(), "5");
+
+    Prefab<TestComponentA, TestComponentB> deserialized;
+    ecs::deserialize(s, deserialized);
+    EXPECT_EQ(deserialized.get<TestComponentA>().value, 5);
+    EXPECT_EQ(deserialized.get<TestComponentB>().value, "enemy");
+
+    MyManager manager;
+    auto entities = deserialized.instantiate(manager, 3);
+    EXPECT_EQ(manager.get<TestComponentB>(entities[2]).value, "enemy");
+
+    // Missing components should be reported
+    Prefab<TestComponentA, TestComponentC> missing;
+    EXPECT_THROW(ecs::deserialize(s, missing), std::runtime_error);
+}
 }  // namespace ecs
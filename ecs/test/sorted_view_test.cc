@@ -0,0 +1,121 @@
+#include "ecs/sorted_view.hh"
+
+#include <gtest/gtest.h>
+
+#include "ecs/components.hh"
+
+namespace ecs {
+namespace {
+// Other tests use the same names, so keep these local to this file
+struct Sprite {
+    int layer = 0;
+    float y = 0.0;
+};
+struct Hidden {};
+
+using MyManager = ComponentManager<Sprite, Hidden>;
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(SortedView, ordered_iteration) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 10; ++i) entities.push_back(manager.spawn(Sprite{i % 3, static_cast<float>(i)}));
+
+    auto view = make_sorted_view<Sprite>([](const Sprite& s) { return std::make_pair(s.layer, -s.y); });
+    view.update(manager);
+    ASSERT_EQ(view.size(), 10);
+
+    std::vector<std::pair<int, float>> visited;
+    manager.run_system<Sprite>(view, [&](const Entity&, const Sprite& s) { visited.emplace_back(s.layer, -s.y); });
+    ASSERT_EQ(visited.size(), 10);
+    EXPECT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+    EXPECT_EQ(visited.front(), std::make_pair(0, -9.f));
+    EXPECT_EQ(visited.back(), std::make_pair(2, -2.f));
+}
+
+//
+// #############################################################################
+//
+
+TEST(SortedView, incremental_update) {
+    MyManager manager;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 100; ++i) entities.push_back(manager.spawn(Sprite{0, static_cast<float>(i)}));
+
+    auto view = make_sorted_view<Sprite>([](const Sprite& s) { return s.y; });
+    view.update(manager);
+
+    // Move a few keys, despawn one and add one
+    manager.get<Sprite>(entities[10]).y = 1000.f;
+    manager.get<Sprite>(entities[90]).y = -1000.f;
+    manager.get<Sprite>(entities[50]).y = 20.5f;
+    manager.despawn(entities[3]);
+    auto added = manager.spawn(Sprite{0, 3.5f});
+    view.update(manager);
+
+    std::vector<float> keys;
+    for (const auto& entry : view) keys.push_back(entry.key);
+    ASSERT_EQ(keys.size(), 100);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    EXPECT_EQ(keys.front(), -1000.f);
+    EXPECT_EQ(keys.back(), 1000.f);
+
+    // Visiting should line up with the keys in the view
+    size_t index = 0;
+    manager.run_system<Sprite>(view, [&](const Entity&, const Sprite& s) { EXPECT_EQ(s.y, keys[index++]); });
+    EXPECT_EQ(index, 100);
+    EXPECT_NE(std::find_if(view.begin(), view.end(), [&](const auto& e) { return e.id() == added.id(); }), view.end());
+}
+
+//
+// #############################################################################
+//
+
+TEST(SortedView, required_components) {
+    MyManager manager;
+    auto a = manager.spawn(Sprite{0, 1.f});
+    manager.spawn(Sprite{0, 2.f}, Hidden{});
+    auto c = manager.spawn(Sprite{0, 3.f});
+
+    auto view = make_sorted_view<Sprite>([](const Sprite& s) { return -s.y; });
+    view.update(manager);
+
+    std::vector<Entity::Id> visited;
+    manager.run_system<Sprite, Hidden>(view, [&](const Entity& e, Sprite&, Hidden&) { visited.push_back(e.id()); });
+    EXPECT_EQ(visited.size(), 1);
+
+    // Returning true should stop the iteration
+    visited.clear();
+    manager.run_system<Sprite>(view, [&](const Entity& e, Sprite&) {
+        visited.push_back(e.id());
+        return e.id() == a.id();
+    });
+    ASSERT_EQ(visited.size(), 3);
+    EXPECT_EQ(visited.front(), c.id());
+    EXPECT_EQ(visited.back(), a.id());
+}
+
+//
+// #############################################################################
+//
+
+TEST(SortedView, const_system) {
+    MyManager manager;
+    manager.spawn(Sprite{0, 2.f});
+    manager.spawn(Sprite{0, 1.f});
+
+    auto view = make_sorted_view<Sprite>([](const Sprite& s) { return s.y; });
+    view.update(manager);
+
+    // Systems which are const lvalues should work with both the ordered and unordered overloads
+    std::vector<float> visited;
+    const auto system = [&visited](const Entity&, const Sprite& s) { visited.push_back(s.y); };
+    manager.run_system<Sprite>(view, system);
+    manager.run_system<Sprite>(system);
+    EXPECT_EQ(visited, (std::vector<float>{1.f, 2.f, 2.f, 1.f}));
+}
+}  // namespace ecs
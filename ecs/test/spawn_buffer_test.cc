@@ -0,0 +1,116 @@
+#include "ecs/spawn_buffer.hh"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <set>
+#include <thread>
+
+namespace ecs {
+namespace {
+// Other tests use the same names, so keep these local to this file
+struct Position {
+    int x = 0;
+};
+struct Owner {
+    size_t thread = 0;
+};
+
+using MyManager = ComponentManager<Position, Owner>;
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(SpawnBuffer, worker_threads) {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kPerThread = 1000;
+
+    MyManager manager;
+    auto existing = manager.spawn(Position{-1});
+
+    std::vector<SpawnBuffer<Position, Owner>> buffers(kThreads, SpawnBuffer<Position, Owner>{manager});
+    std::vector<std::vector<Entity>> spawned(kThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < kPerThread; ++i) {
+                spawned[t].push_back(buffers[t].spawn(Position{static_cast<int>(i)}, Owner{t}));
+            }
+        });
+    }
+
+    // The main thread can keep spawning while the workers are running
+    auto main_thread = manager.spawn(Position{-2});
+
+    for (auto& thread : threads) thread.join();
+
+    // Nothing is alive until the merge
+    EXPECT_FALSE(manager.is_alive(spawned[0].front()));
+    for (auto& buffer : buffers) {
+        EXPECT_EQ(buffer.size(), kPerThread);
+        buffer.merge();
+        EXPECT_EQ(buffer.size(), 0);
+    }
+
+    std::set<Entity::Id> ids{existing.id(), main_thread.id()};
+    for (size_t t = 0; t < kThreads; ++t) {
+        for (size_t i = 0; i < kPerThread; ++i) {
+            const Entity& entity = spawned[t][i];
+            ids.insert(entity.id());
+            ASSERT_TRUE(manager.is_alive(entity));
+            EXPECT_EQ(manager.get<Position>(entity).x, static_cast<int>(i));
+            EXPECT_EQ(manager.get<Owner>(entity).thread, t);
+        }
+    }
+    EXPECT_EQ(ids.size(), kThreads * kPerThread + 2);
+
+    size_t count = 0;
+    manager.run_system<Position>([&](const Entity&, const Position&) { count++; });
+    EXPECT_EQ(count, kThreads * kPerThread + 2);
+    EXPECT_EQ(manager.get<Position>(main_thread).x, -2);
+}
+
+//
+// #############################################################################
+//
+
+TEST(SpawnBuffer, spawn_reserved) {
+    MyManager manager;
+    auto reserved = manager.reserve();
+    auto spawned = manager.spawn(Position{1});
+    EXPECT_NE(reserved.id(), spawned.id());
+    EXPECT_FALSE(manager.is_alive(reserved));
+
+    manager.spawn_reserved(reserved, Owner{5});
+    EXPECT_TRUE(manager.is_alive(reserved));
+    EXPECT_EQ(manager.get<Owner>(reserved).thread, 5);
+
+    auto spawn_twice = [&]() { manager.spawn_reserved(reserved); };
+    EXPECT_THROW(spawn_twice(), std::runtime_error);
+
+    // Despawned ids are on the free list, reviving one would let spawn() hand it out a second time
+    manager.despawn(spawned);
+    auto spawn_despawned = [&]() { manager.spawn_reserved(spawned); };
+    EXPECT_THROW(spawn_despawned(), std::runtime_error);
+    EXPECT_EQ(manager.spawn(Position{2}).id(), spawned.id());
+}
+
+//
+// #############################################################################
+//
+
+TEST(SpawnBuffer, reserve_out_of_ids) {
+    MyManager manager;
+    Entity last = manager.reserve();
+    while (last.id() < std::numeric_limits<Entity::Id>::max()) last = manager.reserve();
+
+    // Every id has been handed out, wrapping around would give out duplicates
+    EXPECT_THROW(manager.reserve(), std::runtime_error);
+    EXPECT_THROW(manager.reserve(), std::runtime_error);
+
+    manager.spawn_reserved(last, Position{3});
+    EXPECT_EQ(manager.get<Position>(last).x, 3);
+}
+}  // namespace ecs
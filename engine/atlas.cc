@@ -0,0 +1,150 @@
+#include "engine/atlas.hh"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace engine {
+
+//
+// #############################################################################
+//
+
+SkylinePacker::SkylinePacker(size_t width, size_t height) : width_(width), height_(height) {
+    skyline_.push_back({0, 0, width_});
+}
+
+//
+// #############################################################################
+//
+
+std::optional<SkylinePacker::Position> SkylinePacker::insert(size_t width, size_t height) {
+    // Pick the spot where the rectangle ends up lowest, tie breaking by the leftmost spot
+    std::optional<size_t> best_index;
+    size_t best_y = std::numeric_limits<size_t>::max();
+    for (size_t i = 0; i < skyline_.size(); ++i) {
+        std::optional<size_t> y = fit(i, width, height);
+        if (y && *y < best_y) {
+            best_index = i;
+            best_y = *y;
+        }
+    }
+    if (!best_index) return std::nullopt;
+
+    const Position position{skyline_[*best_index].x, best_y};
+
+    // The new segment covers the top of the rectangle, trim (or drop) the segments it now shadows
+    skyline_.insert(skyline_.begin() + *best_index, {position.x, position.y + height, width});
+    const size_t right = position.x + width;
+    for (size_t i = *best_index + 1; i < skyline_.size();) {
+        Segment& segment = skyline_[i];
+        if (segment.x >= right) break;
+
+        const size_t shadowed = std::min(right - segment.x, segment.width);
+        segment.x += shadowed;
+        segment.width -= shadowed;
+        if (segment.width == 0) {
+            skyline_.erase(skyline_.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+
+    // Merge neighbors at the same height to keep the skyline short
+    for (size_t i = 0; i + 1 < skyline_.size();) {
+        if (skyline_[i].y == skyline_[i + 1].y) {
+            skyline_[i].width += skyline_[i + 1].width;
+            skyline_.erase(skyline_.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+
+    return position;
+}
+
+//
+// #############################################################################
+//
+
+size_t SkylinePacker::width() const { return width_; }
+
+//
+// #############################################################################
+//
+
+size_t SkylinePacker::height() const { return height_; }
+
+//
+// #############################################################################
+//
+
+std::optional<size_t> SkylinePacker::fit(size_t index, size_t width, size_t height) const {
+    if (skyline_[index].x + width > width_) return std::nullopt;
+
+    // The rectangle has to sit on top of every segment it spans
+    size_t y = 0;
+    size_t remaining = width;
+    for (size_t i = index; remaining > 0; ++i) {
+        y = std::max(y, skyline_[i].y);
+        remaining -= std::min(remaining, skyline_[i].width);
+    }
+
+    if (y + height > height_) return std::nullopt;
+    return y;
+}
+
+//
+// #############################################################################
+//
+
+Atlas build_atlas(const std::vector<const Bitmap*>& bitmaps, size_t page_size, size_t padding) {
+    // Packing the tallest bitmaps first leaves a much flatter skyline
+    std::vector<size_t> order(bitmaps.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t lhs, size_t rhs) { return bitmaps[lhs]->get_height() > bitmaps[rhs]->get_height(); });
+
+    Atlas atlas;
+    atlas.placements.resize(bitmaps.size());
+
+    std::vector<SkylinePacker> packers;
+    std::vector<std::vector<Bitmap::Color>> pixels;
+    for (size_t index : order) {
+        const Bitmap& bitmap = *bitmaps[index];
+        const size_t width = bitmap.get_width() + 2 * padding;
+        const size_t height = bitmap.get_height() + 2 * padding;
+
+        // Try the existing pages first and start a new one if none have room
+        std::optional<SkylinePacker::Position> position;
+        size_t page = 0;
+        for (; page < packers.size() && !position; ++page) position = packers[page].insert(width, height);
+        if (position) {
+            page--;
+        } else {
+            const size_t new_width = std::max(page_size, width);
+            const size_t new_height = std::max(page_size, height);
+            packers.emplace_back(new_width, new_height);
+            pixels.emplace_back(new_width * new_height, Bitmap::Color{0, 0, 0, 0});
+            position = packers.back().insert(width, height);
+        }
+
+        AtlasPlacement& placement = atlas.placements[index];
+        placement = {page, position->x + padding, position->y + padding};
+
+        // Both the bitmap and the page are row major starting at the top left
+        const size_t page_width = packers[page].width();
+        const auto& source = bitmap.get_pixels();
+        for (size_t row = 0; row < bitmap.get_height(); ++row) {
+            std::copy_n(source.begin() + row * bitmap.get_width(), bitmap.get_width(),
+                        pixels[page].begin() + (placement.y + row) * page_width + placement.x);
+        }
+    }
+
+    atlas.pages.reserve(packers.size());
+    for (size_t page = 0; page < packers.size(); ++page) {
+        atlas.pages.emplace_back(packers[page].width(), packers[page].height(), std::move(pixels[page]));
+    }
+    return atlas;
+}
+}  // namespace engine
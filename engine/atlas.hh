@@ -0,0 +1,81 @@
+#pragma once
+#include <optional>
+#include <vector>
+
+#include "engine/bitmap.hh"
+
+namespace engine {
+
+///
+/// @brief Packs rectangles into a fixed size page by tracking the "skyline", the top edge of everything placed so far.
+/// Each rectangle goes wherever it ends up the lowest (the page origin is the top left, so "lowest" is the smallest
+/// y). This wastes a little more space than maxrects, but it's much simpler and fast enough to run at load time.
+///
+class SkylinePacker {
+public:
+    struct Position {
+        size_t x;
+        size_t y;
+    };
+
+public:
+    SkylinePacker(size_t width, size_t height);
+
+    ///
+    /// @brief Find a spot for a width x height rectangle and reserve it
+    /// @returns the top left of the spot, or nullopt if the rectangle doesn't fit on the page
+    ///
+    std::optional<Position> insert(size_t width, size_t height);
+
+    size_t width() const;
+    size_t height() const;
+
+private:
+    // A horizontal segment of the skyline, everything below y is (potentially) used
+    struct Segment {
+        size_t x;
+        size_t y;
+        size_t width;
+    };
+
+    ///
+    /// @brief Where a rectangle of the given size would go if its left edge lined up with the segment at index
+    ///
+    std::optional<size_t> fit(size_t index, size_t width, size_t height) const;
+
+private:
+    size_t width_;
+    size_t height_;
+    std::vector<Segment> skyline_;
+};
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Where a bitmap ended up in the atlas, in pixels from the top left of the page
+///
+struct AtlasPlacement {
+    size_t page;
+    size_t x;
+    size_t y;
+};
+
+///
+/// @brief A set of bitmaps packed into a few shared pages
+///
+struct Atlas {
+    std::vector<Bitmap> pages;
+
+    // One for each input bitmap, in the same order
+    std::vector<AtlasPlacement> placements;
+};
+
+///
+/// @brief Pack the bitmaps into as few pages as possible. Pages are page_size x page_size unless a bitmap is larger,
+/// then it gets a page sized to fit. Each bitmap is surrounded by padding transparent pixels so that filtering doesn't
+/// bleed between neighbors.
+///
+Atlas build_atlas(const std::vector<const Bitmap*>& bitmaps, size_t page_size = 2048, size_t padding = 1);
+}  // namespace engine
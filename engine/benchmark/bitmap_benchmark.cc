@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "engine/bitmap.hh"
+
+// Decodes 4k x 4k bitmaps at 24 and 32 bits per pixel, and times the pixel conversion on its own (SIMD and scalar).
+// Run with: bazel run //engine:bitmap_benchmark
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kDim = 4096;
+constexpr size_t kIterations = 10;
+
+std::filesystem::path write_bitmap(uint16_t bits_per_pixel) {
+    const uint32_t row_bytes = (kDim * bits_per_pixel + 31) / 32 * 4;
+    const uint32_t offset = 14 + 40;
+
+    std::vector<uint8_t> file;
+    auto write = [&file](auto value) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        file.insert(file.end(), bytes, bytes + sizeof(value));
+    };
+    write(uint16_t{19778});
+    write(uint32_t{offset + row_bytes * kDim});
+    write(uint32_t{0});
+    write(offset);
+
+    write(uint32_t{40});
+    write(kDim);
+    write(kDim);
+    write(uint16_t{1});
+    write(bits_per_pixel);
+    for (size_t i = 0; i < 6; ++i) write(uint32_t{0});
+
+    std::mt19937 generator{0};
+    std::uniform_int_distribution<int> byte{0, 255};
+    file.reserve(file.size() + row_bytes * kDim);
+    for (size_t i = 0; i < row_bytes * kDim; ++i) file.push_back(byte(generator));
+
+    const auto path = std::filesystem::temp_directory_path() / ("bitmap_benchmark_" + std::to_string(bits_per_pixel));
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), file.size());
+    return path;
+}
+
+template <typename F>
+double best_ms(F&& f) {
+    double best = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < kIterations; ++i) {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+void report(const std::string& name, double ms, size_t bytes) {
+    std::cout << "  " << name << ": " << ms << "ms (" << bytes / (ms * 1e6) << " GB/s)\n";
+}
+}  // namespace
+
+int main() {
+    std::cout << "Bitmap decode, " << kDim << "x" << kDim << ", best of " << kIterations << " ("
+              << engine::detail::pixel_conversion_name() << ")\n";
+
+    for (uint16_t bits_per_pixel : {24, 32}) {
+        const auto path = write_bitmap(bits_per_pixel);
+        const size_t bytes = std::filesystem::file_size(path);
+        std::cout << bits_per_pixel << " bits per pixel:\n";
+
+        report("Bitmap(path)", best_ms([&]() { engine::Bitmap bitmap{path}; }), bytes);
+
+        // The conversion alone, from a buffer which is already in memory
+        std::vector<uint8_t> source(size_t{kDim} * kDim * bits_per_pixel / 8);
+        std::vector<engine::Bitmap::Color> destination(size_t{kDim} * kDim);
+        for (bool simd : {true, false}) {
+            const double ms = best_ms([&]() {
+                engine::detail::convert_pixels(source.data(), destination.data(), destination.size(), bits_per_pixel,
+                                               simd);
+            });
+            report(simd ? "convert_pixels (SIMD)" : "convert_pixels (scalar)", ms, source.size());
+        }
+
+        std::filesystem::remove(path);
+    }
+}
@@ -1,8 +1,22 @@
 #include "bitmap.hh"
 
-#include <cmath>
-#include <fstream>
-#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__)
+#define ENGINE_BITMAP_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define ENGINE_BITMAP_NEON
+#include <arm_neon.h>
+#endif
+
 namespace engine {
 
 //
@@ -10,31 +24,270 @@ namespace engine {
 //
 
 namespace {
+using Color = Bitmap::Color;
+
 template <typename T>
-T read(std::istream& stream) {
+T read(const uint8_t* data) {
     T t;
-    stream.read(reinterpret_cast<char*>(&t), sizeof(T));
+    std::memcpy(&t, data, sizeof(T));
     return t;
 }
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Read only view of an entire file, unmapped when destroyed
+///
+class MappedFile {
+public:
+    MappedFile(const std::filesystem::path& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Unable to open bitmap file: " + path.string());
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Unable to stat bitmap file: " + path.string());
+        }
+        size_ = info.st_size;
+
+        // Mapping nothing isn't allowed, the header checks will reject the file instead
+        void* data = size_ == 0 ? nullptr : ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) throw std::runtime_error("Unable to map bitmap file: " + path.string());
+
+        // The pixels are read front to back exactly once
+        if (data) ::madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const uint8_t*>(data);
+    }
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+//
+// #############################################################################
+//
+
+void convert_bgr_scalar(const uint8_t* source, Color* destination, size_t count) {
+    for (size_t i = 0; i < count; ++i, source += 3) {
+        destination[i] = Color{source[0], source[1], source[2], 0xFF};
+    }
+}
+
+void convert_bgra_scalar(const uint8_t* source, Color* destination, size_t count) {
+    for (size_t i = 0; i < count; ++i, source += 4) {
+        // Looks like if the alpha is zero, GIMP may not have zero pixel values
+        destination[i] = source[3] == 0 ? Color{0, 0, 0, 0} : Color{source[0], source[1], source[2], source[3]};
+    }
+}
+
+//
+// #############################################################################
+//
+
+#if defined(ENGINE_BITMAP_X86)
+// Spreads 4 packed BGR pixels out to BGRA, the -1s zero the alpha bytes which are then filled in
+#define BGR_TO_BGRA_SHUFFLE 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+constexpr int kAlphaMask = static_cast<int>(0xFF000000);
+
+__attribute__((target("ssse3"))) void convert_bgr_ssse3(const uint8_t* source, Color* destination, size_t count) {
+    const __m128i shuffle = _mm_setr_epi8(BGR_TO_BGRA_SHUFFLE);
+    const __m128i alpha = _mm_set1_epi32(kAlphaMask);
+
+    // Each load reads 16 bytes but only uses 12, so stop while the whole load is still in bounds
+    size_t i = 0;
+    for (; i + 6 <= count; i += 4) {
+        const __m128i bgr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 3 * i));
+        const __m128i bgra = _mm_or_si128(_mm_shuffle_epi8(bgr, shuffle), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), bgra);
+    }
+    convert_bgr_scalar(source + 3 * i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void convert_bgr_avx2(const uint8_t* source, Color* destination, size_t count) {
+    const __m256i shuffle = _mm256_setr_epi8(BGR_TO_BGRA_SHUFFLE, BGR_TO_BGRA_SHUFFLE);
+    const __m256i alpha = _mm256_set1_epi32(kAlphaMask);
+
+    // The shuffle can't cross 128 bit lanes, so each lane is loaded with its own 4 pixels
+    size_t i = 0;
+    for (; i + 10 <= count; i += 8) {
+        const uint8_t* pixels = source + 3 * i;
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 12));
+        const __m256i bgr = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        const __m256i bgra = _mm256_or_si256(_mm256_shuffle_epi8(bgr, shuffle), alpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), bgra);
+    }
+    convert_bgr_scalar(source + 3 * i, destination + i, count - i);
+}
+#undef BGR_TO_BGRA_SHUFFLE
+
+// SSE2 is always available on x86_64
+void convert_bgra_sse2(const uint8_t* source, Color* destination, size_t count) {
+    const __m128i alpha = _mm_set1_epi32(kAlphaMask);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i));
+
+        // All ones for the pixels with zero alpha, which are cleared entirely
+        const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(bgra, alpha), _mm_setzero_si128());
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_andnot_si128(transparent, bgra));
+    }
+    convert_bgra_scalar(source + 4 * i, destination + i, count - i);
+}
+
+__attribute__((target("avx2"))) void convert_bgra_avx2(const uint8_t* source, Color* destination, size_t count) {
+    const __m256i alpha = _mm256_set1_epi32(kAlphaMask);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i bgra = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + 4 * i));
+        const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(bgra, alpha), _mm256_setzero_si256());
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_andnot_si256(transparent, bgra));
+    }
+    convert_bgra_scalar(source + 4 * i, destination + i, count - i);
+}
+#endif
+
+//
+// #############################################################################
+//
+
+#if defined(ENGINE_BITMAP_NEON)
+void convert_bgr_neon(const uint8_t* source, Color* destination, size_t count) {
+    // The loads and stores (de)interleave the channels, so no shuffling is needed
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x3_t bgr = vld3q_u8(source + 3 * i);
+        const uint8x16x4_t bgra = {{bgr.val[0], bgr.val[1], bgr.val[2], vdupq_n_u8(0xFF)}};
+        vst4q_u8(reinterpret_cast<uint8_t*>(destination + i), bgra);
+    }
+    convert_bgr_scalar(source + 3 * i, destination + i, count - i);
+}
+
+void convert_bgra_neon(const uint8_t* source, Color* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t bgra = vld4q_u8(source + 4 * i);
+
+        // All ones for the pixels with zero alpha, which have their color cleared
+        const uint8x16_t transparent = vceqq_u8(bgra.val[3], vdupq_n_u8(0));
+        for (size_t channel = 0; channel < 3; ++channel) {
+            bgra.val[channel] = vbicq_u8(bgra.val[channel], transparent);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t*>(destination + i), bgra);
+    }
+    convert_bgra_scalar(source + 4 * i, destination + i, count - i);
+}
+#endif
+
+//
+// #############################################################################
+//
+
+struct Converters {
+    void (*bgr)(const uint8_t*, Color*, size_t);
+    void (*bgra)(const uint8_t*, Color*, size_t);
+    const char* name;
+};
+
+///
+/// @brief The fastest conversions this CPU supports, picked the first time they're needed
+///
+const Converters& simd_converters() {
+    static const Converters converters = []() -> Converters {
+#if defined(ENGINE_BITMAP_X86)
+        if (__builtin_cpu_supports("avx2")) return {convert_bgr_avx2, convert_bgra_avx2, "AVX2"};
+        if (__builtin_cpu_supports("ssse3")) return {convert_bgr_ssse3, convert_bgra_sse2, "SSSE3"};
+        return {convert_bgr_scalar, convert_bgra_sse2, "SSE2"};
+#elif defined(ENGINE_BITMAP_NEON)
+        return {convert_bgr_neon, convert_bgra_neon, "NEON"};
+#else
+        return {convert_bgr_scalar, convert_bgra_scalar, "scalar"};
+#endif
+    }();
+    return converters;
+}
 }  // namespace
 
 //
 // #############################################################################
 //
 
+void detail::convert_pixels(const uint8_t* source, Color* destination, size_t count, uint16_t bits_per_pixel,
+                            bool simd) {
+    static constexpr Converters kScalar{convert_bgr_scalar, convert_bgra_scalar, "scalar"};
+    const Converters& converters = simd ? simd_converters() : kScalar;
+
+    if (bits_per_pixel == 24) {
+        converters.bgr(source, destination, count);
+    } else if (bits_per_pixel == 32) {
+        converters.bgra(source, destination, count);
+    } else {
+        throw std::runtime_error("Only supporting 24 or 32 bits per pixel.");
+    }
+}
+
+//
+// #############################################################################
+//
+
+const char* detail::pixel_conversion_name() { return simd_converters().name; }
+
+//
+// #############################################################################
+//
+
 Bitmap::Bitmap(const std::filesystem::path& path) {
     if (!std::filesystem::exists(path))
         throw std::runtime_error(std::string("Bitmap file doesn't exist: ") + std::string(path));
-    std::ifstream stream(path, std::ios::binary);
+    const MappedFile file(path);
 
-    file_header_ = parse_file_header(stream);
-    if (file_header_.size != std::filesystem::file_size(path)) {
+    file_header_ = parse_file_header(file.data(), file.size());
+    if (file_header_.size != file.size()) {
         throw std::runtime_error("Header size mismatch.");
     }
 
-    info_header_ = parse_info_header(stream);
+    info_header_ = parse_info_header(file.data(), file.size());
+
+    pixels_ = parse_pixels(file.data(), file.size(), info_header_);
 
-    pixels_ = parse_pixels(stream, info_header_);
+    // Top-down bitmaps have been flipped by now, so only keep the actual height
+    const int32_t height = static_cast<int32_t>(info_header_.height);
+    info_header_.height = height < 0 ? -height : height;
+}
+
+//
+// #############################################################################
+//
+
+Bitmap::Bitmap(size_t width, size_t height, std::vector<Color> pixels)
+    : file_header_{}, info_header_{}, pixels_(std::move(pixels)) {
+    if (pixels_.size() != width * height) {
+        throw std::runtime_error("Bitmap has " + std::to_string(pixels_.size()) + " pixels, expected " +
+                                 std::to_string(width * height));
+    }
+
+    info_header_.size = sizeof(InfoHeader);
+    info_header_.width = width;
+    info_header_.height = height;
+    info_header_.planes = 1;
+    info_header_.bits_per_pixel = 32;
+    info_header_.image_size = sizeof(Color) * pixels_.size();
 }
 
 //
@@ -59,8 +312,12 @@ auto Bitmap::get_pixels() const -> const std::vector<Color>& { return pixels_; }
 // #############################################################################
 //
 
-auto Bitmap::parse_file_header(std::istream& stream) const -> FileHeader {
-    FileHeader header = read<FileHeader>(stream);
+auto Bitmap::parse_file_header(const uint8_t* data, size_t size) const -> FileHeader {
+    if (size < sizeof(FileHeader) + sizeof(InfoHeader)) {
+        throw std::runtime_error("Bitmap file is too small: " + std::to_string(size) + " bytes.");
+    }
+
+    FileHeader header = read<FileHeader>(data);
     if (header.type != 19778)  // "BM"
     {
         throw std::runtime_error("Invalid header type.");
@@ -75,8 +332,8 @@ auto Bitmap::parse_file_header(std::istream& stream) const -> FileHeader {
 // #############################################################################
 //
 
-auto Bitmap::parse_info_header(std::istream& stream) const -> InfoHeader {
-    InfoHeader header = read<InfoHeader>(stream);
+auto Bitmap::parse_info_header(const uint8_t* data, size_t size) const -> InfoHeader {
+    InfoHeader header = read<InfoHeader>(data + sizeof(FileHeader));
 
     switch (header.size) {
         // The header we're using can only be parsed if the header size is one of these:
@@ -90,6 +347,11 @@ auto Bitmap::parse_info_header(std::istream& stream) const -> InfoHeader {
             throw std::runtime_error("Invalid InfoHeader size: " + std::to_string(header.size));
     }
 
+    // The full info header is longer than what's parsed, the pixels start after it (and any color masks)
+    if (sizeof(FileHeader) + header.size > size) {
+        throw std::runtime_error("Bitmap file is too small for its InfoHeader.");
+    }
+
     if (header.planes != 1) {
         throw std::runtime_error("Only supporting 1 plane.");
     }
@@ -102,10 +364,6 @@ auto Bitmap::parse_info_header(std::istream& stream) const -> InfoHeader {
     //     throw std::runtime_error("Unable to handle compression.");
     // }
 
-    // We've read to the end of the InfoHeader, but the actual info header will be longer (since we didn't read some
-    // of the data). Seek to the end for color and pixel parsing.
-    stream.seekg(header.size - sizeof(InfoHeader), std::ios::cur);
-
     return header;
 }
 
@@ -113,48 +371,28 @@ auto Bitmap::parse_info_header(std::istream& stream) const -> InfoHeader {
 // #############################################################################
 //
 
-auto Bitmap::parse_pixels(std::istream& stream, const InfoHeader& header) const -> std::vector<Color> {
-    std::vector<uint8_t> pixel_bytes;
-    pixel_bytes.resize(header.image_size);
-    stream.read(reinterpret_cast<char*>(pixel_bytes.data()), pixel_bytes.size());
-
-    std::vector<std::vector<Color>> rows;
-    rows.reserve(header.height);
-
-    size_t index = 0;
-    for (size_t row = 0; row < header.height; ++row) {
-        // Make sure the row starting indices 4 byte aligned
-        if (index % 4 != 0) {
-            index += std::remainder(index, 4);
-        }
-
-        auto& cols = rows.emplace_back();
-        cols.reserve(header.width);
-
-        for (size_t col = 0; col < header.width; ++col) {
-            auto& pixel = cols.emplace_back();
-
-            pixel.blue = pixel_bytes[index++];
-            pixel.green = pixel_bytes[index++];
-            pixel.red = pixel_bytes[index++];
-            pixel.alpha = header.bits_per_pixel == 32 ? pixel_bytes[index++] : 0xFF;
-
-            // Looks like if the alpha is zero, GIMP may not have zero pixel values
-            if (pixel.alpha == 0) {
-                pixel.blue = 0;
-                pixel.green = 0;
-                pixel.red = 0;
-            }
-        }
+auto Bitmap::parse_pixels(const uint8_t* data, size_t size, const InfoHeader& header) const -> std::vector<Color> {
+    // A negative height means the rows are stored top-down, otherwise it's bottom-up
+    const int32_t signed_height = static_cast<int32_t>(header.height);
+    const bool top_down = signed_height < 0;
+    const size_t height = top_down ? -static_cast<int64_t>(signed_height) : signed_height;
+    const size_t width = header.width;
+
+    // Each row on disk is padded to a multiple of 4 bytes
+    const size_t row_bytes = (width * header.bits_per_pixel + 31) / 32 * 4;
+    const size_t offset = file_header_.offset;
+    if (offset > size || row_bytes * height > size - offset) {
+        throw std::runtime_error("Bitmap file is too small for " + std::to_string(width) + "x" +
+                                 std::to_string(height) + " pixels.");
     }
 
-    // Explicitly reverse the rows so that the upper left is (0, 0). This differs from the bottom-up storage
-    std::reverse(rows.begin(), rows.end());
-
-    std::vector<Color> pixels;
-    pixels.reserve(header.height * header.width);
-    for (const auto& row : rows)
-        for (const auto& col : row) pixels.emplace_back(col);
+    // Convert each row straight into its final place, so that the upper left is (0, 0)
+    std::vector<Color> pixels(width * height);
+    const uint8_t* row = data + offset;
+    for (size_t i = 0; i < height; ++i, row += row_bytes) {
+        const size_t destination_row = top_down ? i : height - 1 - i;
+        detail::convert_pixels(row, pixels.data() + destination_row * width, width, header.bits_per_pixel);
+    }
 
     return pixels;
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
 #include <vector>
 
@@ -16,7 +17,7 @@ private:
         uint16_t reserved1;
         uint16_t reserved2;
 
-        // Offset from beginning of file to image data (in bits, should be 1078)
+        // Offset from beginning of file to image data in bytes
         uint32_t offset;
     } __attribute__((packed));
     static_assert(sizeof(FileHeader) == 14);
@@ -27,6 +28,8 @@ private:
         uint32_t size;
 
         uint32_t width;
+
+        // Negative (as an int32_t) if the rows are stored top-down
         uint32_t height;
         uint16_t planes;
         uint16_t bits_per_pixel;
@@ -51,14 +54,22 @@ public:
 public:
     Bitmap(const std::filesystem::path& path);
 
+    ///
+    /// @brief Build a bitmap in memory, the pixels are row major starting from the top left
+    ///
+    Bitmap(size_t width, size_t height, std::vector<Color> pixels);
+
     size_t get_width() const;
     size_t get_height() const;
     const std::vector<Color>& get_pixels() const;
 
 private:
-    FileHeader parse_file_header(std::istream& stream) const;
-    InfoHeader parse_info_header(std::istream& stream) const;
-    std::vector<Color> parse_pixels(std::istream& stream, const InfoHeader& header) const;
+    ///
+    /// @brief Parse from the memory mapped file, data points to the start of the file
+    ///
+    FileHeader parse_file_header(const uint8_t* data, size_t size) const;
+    InfoHeader parse_info_header(const uint8_t* data, size_t size) const;
+    std::vector<Color> parse_pixels(const uint8_t* data, size_t size, const InfoHeader& header) const;
 
 private:
     FileHeader file_header_;
@@ -67,4 +78,19 @@ private:
     // Row major starting from the TOP left of the image (this is flipped from how its stored on disk)
     std::vector<Color> pixels_;
 };
+
+namespace detail {
+///
+/// @brief Convert count pixels of a row on disk into colors: BGR is expanded to opaque BGRA, and fully transparent
+/// BGRA pixels have their color cleared. Used by the decoder, exposed so the SIMD and scalar versions can be tested and
+/// benchmarked against each other.
+///
+void convert_pixels(const uint8_t* source, Bitmap::Color* destination, size_t count, uint16_t bits_per_pixel,
+                    bool simd = true);
+
+///
+/// @brief Instruction set used by convert_pixels() when simd is true (picked at runtime), e.g. "AVX2"
+///
+const char* pixel_conversion_name();
+}  // namespace detail
 }  // namespace engine
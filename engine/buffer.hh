@@ -2,17 +2,37 @@
 #include <OpenGL/gl3.h>
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <optional>
+#include <string>
 #include <variant>
 #include <vector>
 
 #include "engine/gl.hh"
+#include "engine/gl_state.hh"
 #include "engine/vao.hh"
 
 namespace engine {
 
+///
+/// @brief One of several vertex attributes stored interleaved in a single Buffer
+///
+struct InterleavedAttribute {
+    unsigned int index;
+
+    // How many values of each element belong to this attribute
+    int size;
+};
+
+//
+// #############################################################################
+//
+
 ///
 /// @brief Handles getting data to the GPU
 ///
@@ -25,7 +45,9 @@ public:
     Buffer() = default;
 
     ~Buffer() {
+        delete_stream_fences();
         if (handle_) {
+            gl_state().on_delete_buffer(handle());
             gl_check(glDeleteBuffers, 1, &handle());
         }
     }
@@ -33,7 +55,7 @@ public:
 public:
     void init(GLenum target, const VertexArrayObject& vao) {
         vao_ = &vao;
-        set_vertex_attribute_ = []() {};
+        set_vertex_attribute_ = [](size_t) {};
         target_ = target;
 
         handle_.emplace();
@@ -46,12 +68,73 @@ public:
         // Enable this index, only needs to be done once per index
         gl_check_with_vao(this->vao(), glEnableVertexAttribArray, index);
 
-        set_vertex_attribute_ = [index, this]() {
-            gl_check_with_vao(this->vao(), glVertexAttribPointer, index, Stride, enum_type<T>, GL_FALSE, 0, nullptr);
+        set_vertex_attribute_ = [index, this](size_t offset) {
+            gl_check_with_vao(this->vao(), glVertexAttribPointer, index, Stride, enum_type<T>, GL_FALSE, 0,
+                              reinterpret_cast<const void*>(offset));
         };
     }
 
-    void unbind() { gl_check(glBindBuffer, target_, 0); }
+    ///
+    /// @brief Interleave several vertex attributes in the buffer, each element is split between the attributes in the
+    /// order given. With a non-zero divisor the attributes advance once per divisor instances rather than per vertex.
+    ///
+    void init(GLenum target, std::vector<InterleavedAttribute> attributes, const VertexArrayObject& vao,
+              unsigned int divisor = 0) {
+        init(target, vao);
+
+        int total_size = 0;
+        for (const InterleavedAttribute& attribute : attributes) {
+            gl_check_with_vao(this->vao(), glEnableVertexAttribArray, attribute.index);
+            gl_check_with_vao(this->vao(), glVertexAttribDivisor, attribute.index, divisor);
+            total_size += attribute.size;
+        }
+        if (total_size != Stride) {
+            throw std::runtime_error("Interleaved attributes use " + std::to_string(total_size) +
+                                     " values, but the buffer stride is " + std::to_string(Stride));
+        }
+
+        set_vertex_attribute_ = [attributes = std::move(attributes), this](size_t offset) {
+            for (const InterleavedAttribute& attribute : attributes) {
+                gl_check_with_vao(this->vao(), glVertexAttribPointer, attribute.index, attribute.size, enum_type<T>,
+                                  GL_FALSE, sizeof(T) * Stride, reinterpret_cast<const void*>(offset));
+                offset += sizeof(T) * attribute.size;
+            }
+        };
+    }
+
+    ///
+    /// @brief Switch the buffer into streaming mode, which is meant for data that's rewritten every frame (or more).
+    /// Instead of re-specifying the whole buffer on every change, each update is written into the next free part of a
+    /// ring split into kStreamSections sections. Mapping is unsynchronized, so the driver never stalls on implicit
+    /// syncs, instead a fence is placed whenever a section is finished and only waited on before the section is reused.
+    /// The ring grows if a single update doesn't fit in a section.
+    ///
+    /// Persistent mapping (glBufferStorage) would avoid the map/unmap per update, but it needs GL 4.4 and the window
+    /// creates a 4.1 core context (the newest macOS supports).
+    ///
+    /// NOTE: The data for element buffers will start at offset() bytes into the buffer, which needs to be passed to the
+    /// draw call. Vertex attributes are automatically pointed at the most recent data.
+    ///
+    void set_streaming(size_t section_bytes = kDefaultStreamSectionBytes) {
+        streaming_ = true;
+        stream_.section_bytes = 0;
+        stream_.requested_section_bytes = section_bytes;
+    }
+
+    ///
+    /// @brief Offset in bytes to the data in the buffer, this is only non-zero in streaming mode
+    ///
+    size_t offset() const { return stream_.offset; }
+
+    ///
+    /// @brief Element buffers can't be unbound, the binding belongs to whichever VAO is bound (see gl_state.hh)
+    ///
+    void unbind() {
+        if (target_ == GL_ELEMENT_ARRAY_BUFFER) {
+            throw std::runtime_error("Buffer::unbind() on an element buffer would detach it from the bound VAO");
+        }
+        gl_state().bind_buffer(target_, 0);
+    }
 
 private:
     const VertexArrayObject& vao() {
@@ -64,79 +147,184 @@ private:
     }
 
     ///
-    /// @brief Deletes the current buffer and generates a new one. This should be called anytime the size changes
+    /// @brief Make sure the buffer on the GPU can hold all of data_. The capacity grows geometrically and the same
+    /// handle is reused, so the driver only allocates storage when the capacity is exceeded.
+    /// @returns true if the storage was reallocated, in which case all of data_ has already been uploaded
     ///
-    void rebind() {
-        // Some buffer targets require the VAO to be bound (GL_ELEMENT_ARRAY_BUFFER for example)
-        scoped_vao_ptr_bind(vao_);
-        if (handle_) gl_check(glDeleteBuffers, 1, &handle());
+    bool reserve_gpu() {
+        if (data_.size() <= gpu_capacity_) return false;
 
-        handle_.emplace();
-        gl_check(glGenBuffers, 1, &handle());
+        gpu_capacity_ = std::max(data_.size(), 2 * gpu_capacity_);
         sync();
-        set_vertex_attribute_();
+        return true;
     }
 
     ///
-    /// @brief Used when the size of the buffer doesn't change, only the data within
+    /// @brief Re-specify the storage (at the current capacity) and upload all of data_. Since the old storage is
+    /// orphaned, the driver doesn't need to wait for draws which are still using it.
     ///
     void sync() {
-        gl_check(glBindBuffer, target_, handle());
-        gl_check(glBufferData, target_, sizeof(T) * data_.size(), data_.data(),
+        // Some buffer targets require the VAO to be bound (GL_ELEMENT_ARRAY_BUFFER for example)
+        scoped_vao_ptr_bind(vao_);
+        gl_state().bind_buffer(target_, handle());
+        gl_check(glBufferData, target_, sizeof(T) * gpu_capacity_, nullptr,
                  dynamic_ ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+        gl_check(glBufferSubData, target_, 0, sizeof(T) * data_.size(), data_.data());
         dynamic_ = true;  // in case sync is called more than once...
+
+        set_vertex_attribute_(0);
+    }
+
+    ///
+    /// @brief Upload only the data in [begin, end). Falls back to a full sync() if the buffer on the GPU is too small
+    /// or if most of the buffer changed anyway.
+    ///
+    void sync(size_t begin, size_t end) {
+        // The buffer may have shrunk after the data was modified
+        end = std::min(end, data_.size());
+        if (begin >= end) return;
+
+        if (reserve_gpu()) return;
+        if (end - begin > kFullSyncFraction * data_.size()) {
+            sync();
+            return;
+        }
+
+        scoped_vao_ptr_bind(vao_);
+        gl_state().bind_buffer(target_, handle());
+        gl_check(glBufferSubData, target_, sizeof(T) * begin, sizeof(T) * (end - begin), data_.data() + begin);
+    }
+
+    ///
+    /// @brief Write the data into the next spot in the streaming ring, see set_streaming()
+    ///
+    void stream() {
+        const size_t bytes = sizeof(T) * data_.size();
+        if (bytes == 0) return;
+
+        // Some buffer targets require the VAO to be bound (GL_ELEMENT_ARRAY_BUFFER for example)
+        scoped_vao_ptr_bind(vao_);
+        gl_state().bind_buffer(target_, handle());
+
+        if (bytes > stream_.section_bytes) {
+            // Orphan the old storage and allocate a larger ring. Anything in flight keeps using the old storage, so
+            // there is no need to wait on the old fences.
+            delete_stream_fences();
+            stream_.section_bytes = std::max({bytes, stream_.requested_section_bytes, 2 * stream_.section_bytes});
+            stream_.section = 0;
+            stream_.used = 0;
+            gl_check(glBufferData, target_, kStreamSections * stream_.section_bytes, nullptr, GL_STREAM_DRAW);
+        } else if (stream_.used + bytes > stream_.section_bytes) {
+            // Doesn't fit in what's left of this section, mark when the GPU is done with it and move to the next one
+            stream_.fences[stream_.section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            stream_.section = (stream_.section + 1) % kStreamSections;
+            stream_.used = 0;
+            wait_for_stream_fence(stream_.section);
+        }
+
+        stream_.offset = stream_.section * stream_.section_bytes + stream_.used;
+        constexpr GLbitfield kAccess = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void* destination = glMapBufferRange(target_, stream_.offset, bytes, kAccess);
+        if (destination == nullptr) throw_on_gl_error("glMapBufferRange");
+        std::memcpy(destination, data_.data(), bytes);
+        if (glUnmapBuffer(target_) == GL_FALSE) {
+            throw std::runtime_error("Buffer::stream() failed to unmap buffer, the contents may be corrupted.");
+        }
+
+        set_vertex_attribute_(stream_.offset);
+
+        // Keep the next write aligned, some drivers are much slower with unaligned offsets
+        stream_.used += (bytes + kStreamAlignment - 1) / kStreamAlignment * kStreamAlignment;
+    }
+
+    void wait_for_stream_fence(size_t section) {
+        GLsync& fence = stream_.fences[section];
+        if (fence == nullptr) return;
+
+        GLenum result;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kStreamWaitTimeoutNs);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence);
+        fence = nullptr;
+
+        if (result == GL_WAIT_FAILED) throw_on_gl_error("glClientWaitSync");
+    }
+
+    void delete_stream_fences() {
+        for (GLsync& fence : stream_.fences) {
+            if (fence != nullptr) glDeleteSync(fence);
+            fence = nullptr;
+        }
     }
 
     class BatchedUpdateBuffer {
     public:
-        BatchedUpdateBuffer(Buffer<T, Stride>& parent) : parent_(parent), initial_start_(parent_.data_.data()) {}
+        BatchedUpdateBuffer(Buffer<T, Stride>& parent) : parent_(parent) {}
         ~BatchedUpdateBuffer() { finish(); }
 
         void finish() {
-            // Reallocation happened
-            if (initial_start_ != parent_.data_.data()) {
-                parent_.rebind();
-                initial_start_ = parent_.data_.data();
+            // Streaming buffers write the whole thing into a new spot in the ring regardless of what changed
+            if (parent_.streaming_ && modified()) {
+                parent_.stream();
             }
-            // Data was only modified
-            else if (modified_) {
-                parent_.sync();
-                modified_ = false;
+            // Otherwise only send what changed (growing the GPU buffer if needed)
+            else if (modified()) {
+                parent_.sync(dirty_begin_, dirty_end_);
             }
 
-            parent_.unbind();
+            // The buffer is left bound, the state cache skips the bind if it's used again before something else
+            dirty_begin_ = std::numeric_limits<size_t>::max();
+            dirty_end_ = 0;
         }
 
     public:
         void reserve(size_t new_size) { parent_.data_.reserve(new_size); }
-        void resize(size_t new_size) { parent_.data_.resize(new_size); }
+        void resize(size_t new_size) {
+            if (new_size > parent_.data_.size()) mark_dirty(parent_.data_.size(), new_size);
+            parent_.data_.resize(new_size);
+        }
         size_t size() const { return parent_.data_.size(); }
+        template <typename It>
+        void assign(It begin, It end) {
+            parent_.data_.assign(begin, end);
+            mark_dirty(0, parent_.data_.size());
+        }
         void push_back(const T& t) {
-            modified_ = true;
+            mark_dirty(parent_.data_.size(), parent_.data_.size() + 1);
             parent_.data_.push_back(t);
         }
         T& operator[](size_t index) {
-            modified_ = true;
+            mark_dirty(index, index + 1);
             return parent_.data_.at(index);
         }
         template <size_t Rows>
         Eigen::Map<Eigen::Matrix<T, Stride, static_cast<int>(Rows)>> elements(size_t index) {
-            modified_ = true;
-
-            // Since the map doesn't handle resizing, we'll do that here. Could use resize() but I want to make sure the
-            // size doubling happens automatically.
+            // Since the map doesn't handle resizing, we'll do that here. Reserve first to make sure the size doubling
+            // happens rather than growing to exactly the required size.
             size_t required_size = Stride * (index + Rows);
-            while (parent_.size() < required_size) push_back({});
+            if (parent_.size() < required_size) {
+                auto& data = parent_.data_;
+                if (data.capacity() < required_size) data.reserve(std::max(required_size, 2 * data.capacity()));
+                resize(required_size);
+            }
 
+            mark_dirty(Stride * index, required_size);
             return Eigen::Map<Eigen::Matrix<T, Stride, static_cast<int>(Rows)>>{&parent_.data_.at(Stride * index)};
         }
         Eigen::Map<Eigen::Matrix<T, Stride, 1>> element(size_t index) { return elements<1>(index); }
 
     private:
-        // modified but not reallocated
-        bool modified_ = false;
+        bool modified() const { return dirty_begin_ < dirty_end_; }
+        void mark_dirty(size_t begin, size_t end) {
+            dirty_begin_ = std::min(dirty_begin_, begin);
+            dirty_end_ = std::max(dirty_end_, end);
+        }
+
+        // Range of data_ (in units of T) modified but not reallocated
+        size_t dirty_begin_ = std::numeric_limits<size_t>::max();
+        size_t dirty_end_ = 0;
         Buffer<T, Stride>& parent_;
-        T* initial_start_;
     };
 
     // Mapping between Type and the GLenum that represents that type
@@ -179,11 +367,36 @@ public:
 private:
     GLenum target_;
     const VertexArrayObject* vao_ = nullptr;  // we don't own this
-    std::function<void()> set_vertex_attribute_;
+
+    // Points the vertex attribute (if there is one) at the data, which starts at the given offset into the buffer
+    std::function<void(size_t)> set_vertex_attribute_;
 
     std::optional<unsigned int> handle_ = std::nullopt;
     std::vector<T> data_;
     bool dynamic_ = false;  // assume it's static, this will change after the first sync()
+
+    // How many elements the buffer on the GPU can hold and when partial updates are no longer worth it
+    size_t gpu_capacity_ = 0;
+    static constexpr double kFullSyncFraction = 0.5;
+
+    static constexpr size_t kStreamSections = 3;
+    static constexpr size_t kDefaultStreamSectionBytes = 1 << 16;
+    static constexpr size_t kStreamAlignment = 64;
+    static constexpr GLuint64 kStreamWaitTimeoutNs = 1'000'000;
+
+    bool streaming_ = false;
+    struct {
+        size_t requested_section_bytes = kDefaultStreamSectionBytes;
+        size_t section_bytes = 0;
+
+        // Which section is being written to, how much of it has been used and where the most recent write went
+        size_t section = 0;
+        size_t used = 0;
+        size_t offset = 0;
+
+        // Signaled once the GPU is done with all commands referencing each section
+        std::array<GLsync, kStreamSections> fences{};
+    } stream_;
 };
 
 }  // namespace engine
@@ -0,0 +1,72 @@
+#include "engine/frame_uniforms.hh"
+
+#include <array>
+
+#include "engine/gl.hh"
+#include "engine/gl_state.hh"
+
+namespace engine {
+
+namespace {
+// Each column of a mat3 is padded to a vec4 in std140
+void pack_matrix(const Eigen::Matrix3f& matrix, float* destination) {
+    for (int col = 0; col < 3; ++col) {
+        for (int row = 0; row < 3; ++row) destination[4 * col + row] = matrix(row, col);
+        destination[4 * col + 3] = 0.f;
+    }
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    if (handle_) {
+        gl_state().on_delete_buffer(*handle_);
+        glDeleteBuffers(1, &*handle_);
+    }
+}
+
+//
+// #############################################################################
+//
+
+void FrameUniformBuffer::init() {
+    auto& handle = handle_.emplace();
+    gl_check(glGenBuffers, 1, &handle);
+
+    gl_state().bind_buffer(GL_UNIFORM_BUFFER, handle);
+    gl_check(glBufferData, GL_UNIFORM_BUFFER, kSizeBytes, nullptr, GL_DYNAMIC_DRAW);
+    gl_check(glBindBufferBase, GL_UNIFORM_BUFFER, kBindingPoint, handle);
+}
+
+//
+// #############################################################################
+//
+
+void FrameUniformBuffer::update(const FrameUniforms& uniforms) {
+    if (!handle_) throw std::runtime_error("FrameUniformBuffer::update() called before FrameUniformBuffer::init()");
+
+    std::array<float, kSizeBytes / sizeof(float)> data{};
+    pack_matrix(uniforms.screen_from_world, &data[0]);
+    pack_matrix(uniforms.world_from_screen, &data[12]);
+    data[24] = uniforms.viewport.x();
+    data[25] = uniforms.viewport.y();
+    data[26] = uniforms.time;
+
+    // Orphan the old contents so the driver doesn't wait for the previous frame to finish using them
+    gl_state().bind_buffer(GL_UNIFORM_BUFFER, *handle_);
+    gl_check(glBufferData, GL_UNIFORM_BUFFER, kSizeBytes, data.data(), GL_DYNAMIC_DRAW);
+}
+
+//
+// #############################################################################
+//
+
+void FrameUniformBuffer::bind_program(GLuint program) {
+    const GLuint index = glGetUniformBlockIndex(program, kBlockName);
+    if (index == GL_INVALID_INDEX) return;
+    gl_check(glUniformBlockBinding, program, index, kBindingPoint);
+}
+}  // namespace engine
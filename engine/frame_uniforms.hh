@@ -0,0 +1,74 @@
+#pragma once
+#include <OpenGL/gl3.h>
+
+#include <Eigen/Dense>
+#include <optional>
+
+namespace engine {
+
+///
+/// @brief Per-frame constants shared by every shader through a uniform block
+///
+struct FrameUniforms {
+    Eigen::Matrix3f screen_from_world = Eigen::Matrix3f::Identity();
+    Eigen::Matrix3f world_from_screen = Eigen::Matrix3f::Identity();
+
+    // Size of the viewport in pixels
+    Eigen::Vector2f viewport = Eigen::Vector2f::Zero();
+
+    // Seconds since the window was created
+    float time = 0.f;
+};
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Holds FrameUniforms on the GPU. Shaders use it by declaring kFrameUniformsGlsl (after the #version line),
+/// Shader::init() takes care of binding the block. The buffer is updated once per frame by the Window, so individual
+/// managers don't need to look up or upload the camera themselves.
+///
+class FrameUniformBuffer {
+public:
+    static constexpr GLuint kBindingPoint = 0;
+    static constexpr const char* kBlockName = "Frame";
+
+    // The std140 layout of FrameUniforms, a mat3 takes 3 vec4 columns
+    static constexpr size_t kSizeBytes = 112;
+
+public:
+    FrameUniformBuffer() = default;
+    ~FrameUniformBuffer();
+
+    FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer(FrameUniformBuffer&&) = delete;
+    FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer& operator=(FrameUniformBuffer&&) = delete;
+
+public:
+    void init();
+    void update(const FrameUniforms& uniforms);
+
+    ///
+    /// @brief Point the program's Frame block (if it has one) at kBindingPoint. GL 4.1 doesn't support the binding
+    /// layout qualifier, so this has to be done after linking.
+    ///
+    static void bind_program(GLuint program);
+
+private:
+    std::optional<GLuint> handle_;
+};
+
+///
+/// @brief Declaration of the uniform block to paste into shaders
+///
+constexpr const char* kFrameUniformsGlsl = R"(
+layout (std140) uniform Frame {
+    mat3 screen_from_world;
+    mat3 world_from_screen;
+    vec2 viewport;
+    float time;
+};
+)";
+}  // namespace engine
@@ -2,9 +2,101 @@
 
 #include <OpenGL/gl3.h>
 
+#include <cstring>
+#include <iostream>
 #include <sstream>
 
 namespace engine {
+
+namespace detail {
+GlCheckMode gl_check_mode = kDefaultGlCheckMode;
+}
+
+namespace {
+#if defined(GL_KHR_debug) || defined(GL_VERSION_4_3)
+void APIENTRY debug_message_callback(GLenum, GLenum type, GLuint id, GLenum severity, GLsizei, const GLchar* message,
+                                       const void*) {
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+
+    // This is called from inside the driver, so it's not safe to throw here. The error will still be picked up by
+    // the glGetError() after the call.
+    std::cerr << "GL debug message (id: " << id << (type == GL_DEBUG_TYPE_ERROR ? ", error" : "") << "): " << message
+              << "\n";
+}
+
+#endif
+
+void enable_debug_output() {
+#if defined(GL_KHR_debug) || defined(GL_VERSION_4_3)
+    if (!has_gl_extension("GL_KHR_debug")) return;
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(debug_message_callback, nullptr);
+#endif
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+void set_gl_check_mode(GlCheckMode mode) {
+    if (kDefaultGlCheckMode == GlCheckMode::kOff) return;
+
+    if (mode == GlCheckMode::kDebug && detail::gl_check_mode != GlCheckMode::kDebug) enable_debug_output();
+    detail::gl_check_mode = mode;
+}
+
+//
+// #############################################################################
+//
+
+bool has_gl_extension(const char* name) {
+    GLint num_extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+    for (GLint i = 0; i < num_extensions; ++i) {
+        const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+//
+// #############################################################################
+//
+
+GlCheckMode gl_check_mode() { return detail::gl_check_mode; }
+
+//
+// #############################################################################
+//
+
+void init_gl_checks() {
+    if (detail::gl_check_mode == GlCheckMode::kDebug) enable_debug_output();
+}
+
+//
+// #############################################################################
+//
+
+void check_gl_errors(const char* pass) {
+    if (detail::gl_check_mode == GlCheckMode::kOff) return;
+
+    // There can be more than one error flag set, drain all of them
+    std::string errors;
+    for (std::string error = get_gl_error(); !error.empty(); error = get_gl_error()) {
+        errors += errors.empty() ? error : ", " + error;
+    }
+    if (errors.empty()) return;
+
+    throw std::runtime_error(std::string("GL errors during ") + pass + ": " + errors);
+}
+
+//
+// #############################################################################
+//
+
 void throw_on_gl_error(std::string action) {
     std::stringstream ss;
     if (!action.empty()) ss << action << " failed. ";
@@ -20,6 +112,19 @@ void throw_on_gl_error(std::string action) {
 // #############################################################################
 //
 
+void throw_on_gl_error(const char* file, int line, const char* call) {
+    std::string error = get_gl_error();
+    if (error.empty()) return;
+
+    std::stringstream ss;
+    ss << "\n\t" << file << "(" << line << "): " << call << " failed. Error code: " << error;
+    throw std::runtime_error(ss.str());
+}
+
+//
+// #############################################################################
+//
+
 #define error_string_case(enum_value) \
     case enum_value:                  \
         return std::to_string(enum_value) + " (" + #enum_value ")"
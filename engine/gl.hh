@@ -8,19 +8,71 @@
 #include "engine/vao.hh"
 
 namespace engine {
+
+///
+/// @brief How GL calls made through gl_check() are checked for errors. glGetError() forces the driver to sync, so
+/// checking after every call is expensive.
+///  - kOff: never check
+///  - kDeferred: only check at check_gl_errors(), which Window::render_loop() calls once per frame
+///  - kDebug: check after every call, and also report driver messages through KHR_debug when the context supports it
+///            (the 4.1 core context on macOS doesn't)
+///
+/// The default is kDeferred, build with -DENGINE_GL_CHECK_MODE=kDebug (--config=gl_debug) or kOff (--config=gl_off)
+/// to change it. When built with kOff, gl_check() compiles down to just the call.
+///
+enum class GlCheckMode { kOff, kDeferred, kDebug };
+
+#ifndef ENGINE_GL_CHECK_MODE
+#define ENGINE_GL_CHECK_MODE kDeferred
+#endif
+constexpr GlCheckMode kDefaultGlCheckMode = GlCheckMode::ENGINE_GL_CHECK_MODE;
+
+namespace detail {
+extern GlCheckMode gl_check_mode;
+}
+
+///
+/// @brief Change the mode at runtime (unless built with kOff). Switching to kDebug requires a current context.
+///
+void set_gl_check_mode(GlCheckMode mode);
+GlCheckMode gl_check_mode();
+
+///
+/// @brief Set up error checking for the current context, should be called once the context is created
+///
+void init_gl_checks();
+
+///
+/// @brief Check for any errors since the last check, throwing if there were any. Does nothing in kOff mode.
+/// @param pass used to identify where the errors came from
+///
+void check_gl_errors(const char* pass);
+
+///
+/// @brief Whether the current context supports the extension, e.g. "GL_KHR_debug"
+///
+bool has_gl_extension(const char* name);
+
 std::string get_gl_error();
 void throw_on_gl_error(std::string action = "");
+
+///
+/// @brief Used by gl_check(), the error message is only built if there actually was an error
+///
+void throw_on_gl_error(const char* file, int line, const char* call);
 }  // namespace engine
-#define gl_check(func, ...)                                                                          \
-    func(__VA_ARGS__);                                                                               \
-    do {                                                                                             \
-        std::stringstream ss;                                                                        \
-        ss << "\n\t" << __FILE__ << "(" << __LINE__ << "): " << #func << "(" << #__VA_ARGS__ << ")"; \
-        ::engine::throw_on_gl_error(ss.str());                                                       \
+
+#define gl_check(func, ...)                                                              \
+    do {                                                                                 \
+        func(__VA_ARGS__);                                                               \
+        if (::engine::kDefaultGlCheckMode != ::engine::GlCheckMode::kOff &&              \
+            ::engine::detail::gl_check_mode == ::engine::GlCheckMode::kDebug) {          \
+            ::engine::throw_on_gl_error(__FILE__, __LINE__, #func "(" #__VA_ARGS__ ")"); \
+        }                                                                                \
     } while (false)
 
 #define gl_check_with_vao(vao, func, ...) \
     do {                                  \
         scoped_vao_bind(vao);             \
         gl_check(func, __VA_ARGS__);      \
-    } while (false)\
+    } while (false)
@@ -0,0 +1,228 @@
+#include "engine/gl_state.hh"
+
+#include <stdexcept>
+#include <string>
+
+#include "engine/gl.hh"
+
+namespace engine {
+
+//
+// #############################################################################
+//
+
+void GlState::use_program(GLuint program) {
+    if (update(program_, program, counters_.program)) gl_check(glUseProgram, program);
+}
+
+//
+// #############################################################################
+//
+
+void GlState::bind_vertex_array(GLuint vertex_array) {
+    if (update(vertex_array_, vertex_array, counters_.vertex_array)) gl_check(glBindVertexArray, vertex_array);
+}
+
+//
+// #############################################################################
+//
+
+void GlState::bind_buffer(GLenum target, GLuint buffer) {
+    const std::optional<size_t> index = buffer_index(target);
+    if (!index) {
+        counters_.buffer.issued++;
+        gl_check(glBindBuffer, target, buffer);
+        return;
+    }
+
+    if (update(buffers_[*index], buffer, counters_.buffer)) gl_check(glBindBuffer, target, buffer);
+}
+
+//
+// #############################################################################
+//
+
+void GlState::active_texture(size_t unit) {
+    if (unit >= kTextureUnits) {
+        throw std::runtime_error("Texture unit " + std::to_string(unit) + " is out of range, only " +
+                                 std::to_string(kTextureUnits) + " are supported.");
+    }
+    if (update(active_texture_, unit, counters_.texture)) gl_check(glActiveTexture, GL_TEXTURE0 + unit);
+}
+
+//
+// #############################################################################
+//
+
+void GlState::bind_texture(GLenum target, GLuint texture) {
+    const std::optional<size_t> index = texture_index(target);
+    if (!index || !active_texture_) {
+        counters_.texture.issued++;
+        gl_check(glBindTexture, target, texture);
+        return;
+    }
+
+    if (update(textures_[*active_texture_][*index], texture, counters_.texture)) {
+        gl_check(glBindTexture, target, texture);
+    }
+}
+
+//
+// #############################################################################
+//
+
+void GlState::set_enabled(GLenum capability, bool enabled) {
+    const std::optional<size_t> index = capability_index(capability);
+    if (index && !update(capabilities_[*index], enabled, counters_.fixed_function)) return;
+    if (!index) counters_.fixed_function.issued++;
+
+    if (enabled) {
+        gl_check(glEnable, capability);
+    } else {
+        gl_check(glDisable, capability);
+    }
+}
+
+//
+// #############################################################################
+//
+
+void GlState::blend_func(GLenum source, GLenum destination) {
+    if (update(blend_func_, std::make_pair(source, destination), counters_.fixed_function)) {
+        gl_check(glBlendFunc, source, destination);
+    }
+}
+
+//
+// #############################################################################
+//
+
+void GlState::depth_func(GLenum func) {
+    if (update(depth_func_, func, counters_.fixed_function)) gl_check(glDepthFunc, func);
+}
+
+//
+// #############################################################################
+//
+
+void GlState::depth_mask(bool write) {
+    if (update(depth_mask_, write, counters_.fixed_function)) gl_check(glDepthMask, write ? GL_TRUE : GL_FALSE);
+}
+
+//
+// #############################################################################
+//
+
+void GlState::on_delete_program(GLuint program) {
+    if (program_ == program) program_ = 0u;
+}
+
+//
+// #############################################################################
+//
+
+void GlState::on_delete_vertex_array(GLuint vertex_array) {
+    if (vertex_array_ == vertex_array) vertex_array_ = 0u;
+}
+
+//
+// #############################################################################
+//
+
+void GlState::on_delete_buffer(GLuint buffer) {
+    for (auto& bound : buffers_) {
+        if (bound == buffer) bound = 0u;
+    }
+}
+
+//
+// #############################################################################
+//
+
+void GlState::on_delete_texture(GLuint texture) {
+    for (auto& unit : textures_) {
+        for (auto& bound : unit) {
+            if (bound == texture) bound = 0u;
+        }
+    }
+}
+
+//
+// #############################################################################
+//
+
+void GlState::invalidate() {
+    // Everything except the counters
+    Counters counters = counters_;
+    *this = {};
+    counters_ = counters;
+}
+
+//
+// #############################################################################
+//
+
+std::optional<size_t> GlState::buffer_index(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER:
+            return 0;
+        case GL_UNIFORM_BUFFER:
+            return 1;
+        case GL_PIXEL_UNPACK_BUFFER:
+            return 2;
+        case GL_PIXEL_PACK_BUFFER:
+            return 3;
+        case GL_COPY_READ_BUFFER:
+            return 4;
+        case GL_COPY_WRITE_BUFFER:
+            return 5;
+        default:
+            return std::nullopt;
+    }
+}
+
+//
+// #############################################################################
+//
+
+std::optional<size_t> GlState::texture_index(GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D:
+            return 0;
+        case GL_TEXTURE_2D_ARRAY:
+            return 1;
+        default:
+            return std::nullopt;
+    }
+}
+
+//
+// #############################################################################
+//
+
+std::optional<size_t> GlState::capability_index(GLenum capability) {
+    switch (capability) {
+        case GL_BLEND:
+            return 0;
+        case GL_DEPTH_TEST:
+            return 1;
+        case GL_CULL_FACE:
+            return 2;
+        case GL_SCISSOR_TEST:
+            return 3;
+        case GL_PRIMITIVE_RESTART:
+            return 4;
+        default:
+            return std::nullopt;
+    }
+}
+
+//
+// #############################################################################
+//
+
+GlState& gl_state() {
+    static GlState state;
+    return state;
+}
+}  // namespace engine
@@ -0,0 +1,113 @@
+#pragma once
+#include <OpenGL/gl3.h>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+namespace engine {
+
+///
+/// @brief Shadows the GL state which is changed the most (program, VAO, buffer bindings, textures, blend and depth)
+/// so that calls which wouldn't change anything are skipped. All changes to this state should go through gl_state(),
+/// otherwise the shadow copy will be wrong. If something outside the engine touches the state, call invalidate().
+///
+/// NOTE: Nothing is unbound after use, in particular a VAO stays bound after its VertexArrayObject::ScopedBinder is
+/// gone. Since the element array binding is part of the VAO, binding (or unbinding) an element buffer changes whichever
+/// VAO happens to be bound, so element buffers should only be bound with their own VAO bound.
+///
+class GlState {
+public:
+    struct Counter {
+        size_t issued = 0;
+        size_t elided = 0;
+    };
+    struct Counters {
+        Counter program;
+        Counter vertex_array;
+        Counter buffer;
+        Counter texture;
+        Counter fixed_function;  // enable/disable, blend and depth
+    };
+
+    static constexpr size_t kTextureUnits = 16;
+
+public:
+    void use_program(GLuint program);
+    void bind_vertex_array(GLuint vertex_array);
+
+    ///
+    /// @brief The element array binding is part of the VAO, so those binds are always issued
+    ///
+    void bind_buffer(GLenum target, GLuint buffer);
+
+    void active_texture(size_t unit);
+    void bind_texture(GLenum target, GLuint texture);
+
+    void set_enabled(GLenum capability, bool enabled);
+    void enable(GLenum capability) { set_enabled(capability, true); }
+    void disable(GLenum capability) { set_enabled(capability, false); }
+    void blend_func(GLenum source, GLenum destination);
+    void depth_func(GLenum func);
+    void depth_mask(bool write);
+
+    ///
+    /// @brief Should be called when an object is deleted, GL resets any bindings to a deleted object
+    ///
+    void on_delete_program(GLuint program);
+    void on_delete_vertex_array(GLuint vertex_array);
+    void on_delete_buffer(GLuint buffer);
+    void on_delete_texture(GLuint texture);
+
+    ///
+    /// @brief Forget everything, so that the next call of each kind is issued
+    ///
+    void invalidate();
+
+    const Counters& counters() const { return counters_; }
+    void reset_counters() { counters_ = {}; }
+
+private:
+    // Updates the shadow value and the counter, returns true if the call needs to be issued
+    template <typename T>
+    bool update(std::optional<T>& current, const T& value, Counter& counter) {
+        if (current == value) {
+            counter.elided++;
+            return false;
+        }
+        current = value;
+        counter.issued++;
+        return true;
+    }
+
+    // Index into the tracked buffer targets and capabilities, or nullopt if it isn't tracked
+    static std::optional<size_t> buffer_index(GLenum target);
+    static std::optional<size_t> texture_index(GLenum target);
+    static std::optional<size_t> capability_index(GLenum capability);
+
+private:
+    Counters counters_;
+
+    std::optional<GLuint> program_;
+    std::optional<GLuint> vertex_array_;
+
+    // GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_PACK_BUFFER, GL_COPY_READ_BUFFER and
+    // GL_COPY_WRITE_BUFFER
+    std::array<std::optional<GLuint>, 6> buffers_;
+
+    // For each unit, GL_TEXTURE_2D and GL_TEXTURE_2D_ARRAY
+    std::optional<size_t> active_texture_;
+    std::array<std::array<std::optional<GLuint>, 2>, kTextureUnits> textures_;
+
+    // GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST and GL_PRIMITIVE_RESTART
+    std::array<std::optional<bool>, 5> capabilities_;
+    std::optional<std::pair<GLenum, GLenum>> blend_func_;
+    std::optional<GLenum> depth_func_;
+    std::optional<bool> depth_mask_;
+};
+
+///
+/// @brief The state of the (single) context used by the engine
+///
+GlState& gl_state();
+}  // namespace engine
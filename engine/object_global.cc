@@ -1,12 +1,39 @@
 #include "engine/object_global.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 namespace engine {
 
 //
 // #############################################################################
 //
 
+void GlobalObjectManager::set_loading_callback(LoadingCallback callback) { loading_callback_ = std::move(callback); }
+
+//
+// #############################################################################
+//
+
 void GlobalObjectManager::init() {
+    std::vector<Shader*> shaders;
+    for (auto& manager : managers_) {
+        for (Shader* shader : manager->shaders()) shaders.push_back(shader);
+    }
+
+    // Submit every build before checking on any of them, the driver may compile them in parallel
+    for (Shader* shader : shaders) shader->begin_init();
+
+    for (;;) {
+        const size_t ready = std::count_if(shaders.begin(), shaders.end(), [](Shader* s) { return s->is_ready(); });
+        if (loading_callback_) loading_callback_(ready, shaders.size());
+        if (ready == shaders.size()) break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // The shaders are built by now, so this is only checking their status and setting up buffers
     for (auto& manager : managers_) {
         manager->init();
     }
@@ -16,10 +43,34 @@ void GlobalObjectManager::init() {
 // #############################################################################
 //
 
+void GlobalObjectManager::record(const Eigen::Matrix3f& screen_from_world) {
+    // Two recordings of the same manager can't be allowed to overlap
+    wait_for_recording();
+
+    if (managers_.empty()) return;
+    if (!pool_) pool_ = std::make_unique<ThreadPool>();
+
+    // This returns before the tasks are done, so they get their own copies of everything
+    recording_.reserve(managers_.size());
+    for (const auto& manager : managers_) {
+        recording_.push_back(pool_->submit([manager, screen_from_world]() { manager->record(screen_from_world); }));
+    }
+}
+
+//
+// #############################################################################
+//
+
 void GlobalObjectManager::render(const Eigen::Matrix3f& screen_from_world) {
+    wait_for_recording();
+
     for (auto& manager : managers_) {
-        manager->render(screen_from_world);
+        manager->submit(queue_);
     }
+
+    // Commands with the same key keep the order the managers were added in
+    queue_.sort();
+    queue_.execute(screen_from_world);
 }
 
 //
@@ -69,4 +120,17 @@ std::shared_ptr<AbstractObjectManager> GlobalObjectManager::get_manager(size_t i
     return managers_.at(index);
 }
 
+//
+// #############################################################################
+//
+
+void GlobalObjectManager::wait_for_recording() {
+    std::vector<std::future<void>> recording = std::move(recording_);
+    recording_.clear();
+
+    // Make sure every task is done before any exception is rethrown, so nothing is still recording afterwards
+    for (auto& future : recording) future.wait();
+    for (auto& future : recording) future.get();
+}
+
 }  // namespace engine
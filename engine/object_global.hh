@@ -1,19 +1,44 @@
 #pragma once
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <vector>
 
 #include "engine/object_manager.hh"
+#include "engine/render_queue.hh"
+#include "engine/thread_pool.hh"
 
 namespace engine {
 class GlobalObjectManager final : AbstractObjectManager {
 public:
     GlobalObjectManager() = default;
+    GlobalObjectManager(GlobalObjectManager&&) = default;
+    GlobalObjectManager& operator=(GlobalObjectManager&&) = default;
     ~GlobalObjectManager() override = default;
 
 public:
+    ///
+    /// @brief Called while init() waits on the shaders, with how many of them are built so far. This lets the caller
+    /// show progress (and keep the window responsive) instead of freezing until everything is compiled.
+    ///
+    using LoadingCallback = std::function<void(size_t ready, size_t total)>;
+    void set_loading_callback(LoadingCallback callback);
+
+    ///
+    /// @brief Start building the shaders of every manager at once, wait for them while calling the loading callback,
+    /// then initialize each manager
+    ///
     void init() override;
 
+    ///
+    /// @brief Start recording every manager in parallel, this returns right away so the GL thread can get on with work
+    /// which doesn't touch the managers (uploads, clearing, ...). The managers mustn't be used until render().
+    ///
+    void record(const Eigen::Matrix3f& screen_from_world) override;
+
+    ///
+    /// @brief Wait for the recording started by record() (rethrowing anything it threw), then submit and draw
+    ///
     void render(const Eigen::Matrix3f& screen_from_world) override;
 
     void update(float dt) override;
@@ -27,5 +52,20 @@ public:
 
 private:
     std::vector<std::shared_ptr<AbstractObjectManager>> managers_;
+
+    // Collects the draws from every manager each frame
+    RenderQueue queue_;
+
+    // The recording started by record(), waited on by render()
+    std::vector<std::future<void>> recording_;
+
+    // Runs record(), created on first use (this also keeps the manager movable). Destroyed first, which waits for any
+    // recording still in flight.
+    std::unique_ptr<ThreadPool> pool_;
+
+    LoadingCallback loading_callback_;
+
+private:
+    void wait_for_recording();
 };
 }  // namespace engine
@@ -9,6 +9,30 @@ namespace engine {
 // #############################################################################
 //
 
+std::vector<Shader*> AbstractObjectManager::shaders() { return {}; }
+
+//
+// #############################################################################
+//
+
+void AbstractObjectManager::record(const Eigen::Matrix3f&) {}
+
+//
+// #############################################################################
+//
+
+void AbstractObjectManager::submit(RenderQueue& queue) { queue.push(SortKey{}, *this); }
+
+//
+// #############################################################################
+//
+
+void AbstractObjectManager::execute(uint32_t, const Eigen::Matrix3f& screen_from_world) { render(screen_from_world); }
+
+//
+// #############################################################################
+//
+
 AbstractSingleShaderObjectManager::AbstractSingleShaderObjectManager(std::string vertex, std::string fragment,
                                                                      std::optional<std::string> geometry)
     : shader_(std::move(vertex), std::move(fragment), std::move(geometry)) {}
@@ -24,11 +48,11 @@ void AbstractSingleShaderObjectManager::init() {
     // Call the child function
     init_with_vao();
 
+    // Shaders using the frame uniform block (see FrameUniformBuffer) don't need this, in which case it's -1
     screen_from_world_loc_ = glGetUniformLocation(shader_.get_program_id(), "screen_from_world");
     if (const std::string error = get_gl_error(); !error.empty()) {
         throw std::runtime_error(
-            std::string("AbstractSingleShaderObjectManager assumes an input variable named 'screen_from_world', but it "
-                        "appears there was an error when loading it: ") +
+            std::string("AbstractSingleShaderObjectManager failed to look up the 'screen_from_world' uniform: ") +
             error);
     }
 }
@@ -37,15 +61,21 @@ void AbstractSingleShaderObjectManager::init() {
 // #############################################################################
 //
 
+std::vector<Shader*> AbstractSingleShaderObjectManager::shaders() { return {&shader_}; }
+
+//
+// #############################################################################
+//
+
 void AbstractSingleShaderObjectManager::render(const Eigen::Matrix3f& screen_from_world) {
     shader_.activate();
 
-    gl_check(glUniformMatrix3fv, screen_from_world_loc_, 1, GL_FALSE, screen_from_world.data());
+    if (screen_from_world_loc_ >= 0) {
+        gl_check(glUniformMatrix3fv, screen_from_world_loc_, 1, GL_FALSE, screen_from_world.data());
+    }
 
     // Call the child function to do the actual rendering
     render_with_vao();
-
-    gl_check(glUseProgram, 0);
 }
 
 //
@@ -1,8 +1,10 @@
 #pragma once
 #include <Eigen/Dense>
 #include <memory>
+#include <vector>
 
 #include "engine/events.hh"
+#include "engine/render_queue.hh"
 #include "engine/shader.hh"
 #include "engine/vao.hh"
 
@@ -17,10 +19,35 @@ public:
     virtual void init() = 0;
 
     ///
-    /// @brief Render objects held by the manager
+    /// @brief The shaders built by init(). Their builds are all started before any manager is initialized, so the
+    /// driver can compile them at the same time. None by default.
+    ///
+    virtual std::vector<Shader*> shaders();
+
+    ///
+    /// @brief Build everything needed for this frame's draws (vertex/instance data, command lists, ...) without making
+    /// any GL calls. This runs on a worker thread, at the same time as the other managers' record() and the GL thread's
+    /// per frame work (texture uploads, clearing), after update() and before submit()/render(). BoxRenderer::submit()
+    /// and LineRenderer::submit() are safe to call from here. Does nothing by default.
+    ///
+    virtual void record(const Eigen::Matrix3f& screen_from_world);
+
+    ///
+    /// @brief Render objects held by the manager, this is called from the thread that owns the GL context
     ///
     virtual void render(const Eigen::Matrix3f& screen_from_world) = 0;
 
+    ///
+    /// @brief Add this manager's draws to the frame's queue. By default a single command which calls render() is
+    /// pushed, managers can override this (along with execute()) to submit a command for each draw.
+    ///
+    virtual void submit(RenderQueue& queue);
+
+    ///
+    /// @brief Execute a command this manager submitted, id is whatever was passed to RenderQueue::push()
+    ///
+    virtual void execute(uint32_t id, const Eigen::Matrix3f& screen_from_world);
+
     ///
     /// @brief Update all of the objects held by the manager
     ///
@@ -48,6 +75,8 @@ public:
 
     void init() override final;
 
+    std::vector<Shader*> shaders() override;
+
     void render(const Eigen::Matrix3f& screen_from_world) override final;
 
 protected:
@@ -0,0 +1,235 @@
+#include "engine/program_cache.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include "engine/gl.hh"
+
+namespace engine {
+
+namespace {
+// FNV-1a, this only needs to tell sources apart, not be cryptographically secure
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t hash(const std::string& data, uint64_t seed) {
+    for (unsigned char c : data) {
+        seed ^= c;
+        seed *= kFnvPrime;
+    }
+
+    // Mix in the length too, so moving text between the sources changes the hash
+    return (seed ^ data.size()) * kFnvPrime;
+}
+
+std::string gl_string(GLenum name) {
+    const auto* value = reinterpret_cast<const char*>(glGetString(name));
+    return value ? value : "";
+}
+
+///
+/// @brief The current user's cache directory, other users shouldn't be able to write to this
+///
+std::optional<std::filesystem::path> user_cache_directory() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) return std::filesystem::path(xdg);
+
+    const char* home = std::getenv("HOME");
+    if (!home || !*home) return std::nullopt;
+#ifdef __APPLE__
+    return std::filesystem::path(home) / "Library" / "Caches";
+#else
+    return std::filesystem::path(home) / ".cache";
+#endif
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+ProgramCache::ProgramCache() {
+    if (auto cache = user_cache_directory()) directory_ = *cache / "engine" / "program_cache";
+}
+
+//
+// #############################################################################
+//
+
+void ProgramCache::set_directory(std::optional<std::filesystem::path> directory) { directory_ = std::move(directory); }
+
+//
+// #############################################################################
+//
+
+bool ProgramCache::enabled() {
+    if (!directory_) return false;
+
+    if (!formats_) {
+        GLint num_formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+
+        formats_.emplace(std::max(num_formats, 0));
+        if (num_formats > 0) glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats_->data());
+    }
+    return !formats_->empty();
+}
+
+//
+// #############################################################################
+//
+
+uint64_t ProgramCache::key(const std::string& vertex, const std::string& fragment,
+                           const std::optional<std::string>& geometry) {
+    if (!driver_) driver_ = gl_string(GL_VENDOR) + "\n" + gl_string(GL_RENDERER) + "\n" + gl_string(GL_VERSION);
+
+    uint64_t result = hash(*driver_, kFnvOffset);
+    result = hash(vertex, result);
+    result = hash(fragment, result);
+    return geometry ? hash(*geometry, result) : result;
+}
+
+//
+// #############################################################################
+//
+
+std::optional<GLuint> ProgramCache::load(uint64_t key) {
+    if (!enabled()) return std::nullopt;
+
+    const std::optional<detail::ProgramBinary> cached = detail::read_program_binary(path(key));
+    if (!cached) return std::nullopt;
+    const GLenum format = cached->format;
+    const std::vector<char>& binary = cached->binary;
+
+    const auto reject = [&]() {
+        stats_.rejected++;
+        std::error_code ignored;
+        std::filesystem::remove(path(key), ignored);
+    };
+
+    // An unknown format would be a GL error, so check it up front. Errors are left for the usual checks to report.
+    if (std::find(formats_->begin(), formats_->end(), static_cast<GLint>(format)) == formats_->end()) {
+        reject();
+        return std::nullopt;
+    }
+
+    // Drivers are still free to reject binaries in a supported format (a different GPU or driver build for example),
+    // which shows up as a failed link rather than an error
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), binary.size());
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+        glDeleteProgram(program);
+        reject();
+        return std::nullopt;
+    }
+    return program;
+}
+
+//
+// #############################################################################
+//
+
+void ProgramCache::store(uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    detail::ProgramBinary binary;
+    binary.binary.resize(length);
+    gl_check(glGetProgramBinary, program, length, nullptr, &binary.format, binary.binary.data());
+
+    // Failing to write the cache shouldn't stop anything, it'll just be a miss next time
+    std::error_code error;
+    std::filesystem::create_directories(*directory_, error);
+    if (error) return;
+
+    detail::write_program_binary(path(key), binary);
+}
+
+//
+// #############################################################################
+//
+
+void ProgramCache::record_hit(std::chrono::nanoseconds duration) {
+    stats_.hits++;
+    stats_.hit_time += duration;
+}
+
+//
+// #############################################################################
+//
+
+void ProgramCache::record_miss(std::chrono::nanoseconds duration) {
+    stats_.misses++;
+    stats_.miss_time += duration;
+}
+
+//
+// #############################################################################
+//
+
+std::filesystem::path ProgramCache::path(uint64_t key) const {
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return *directory_ / name.str();
+}
+
+//
+// #############################################################################
+//
+
+ProgramCache& program_cache() {
+    static ProgramCache cache;
+    return cache;
+}
+
+//
+// #############################################################################
+//
+
+bool detail::write_program_binary(const std::filesystem::path& path, const ProgramBinary& program) {
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    bool written = false;
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&program.format), sizeof(program.format));
+        file.write(program.binary.data(), program.binary.size());
+        file.close();
+        written = static_cast<bool>(file);
+    }
+
+    std::error_code error;
+    if (written) std::filesystem::rename(temporary, path, error);
+    if (!written || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+//
+// #############################################################################
+//
+
+std::optional<detail::ProgramBinary> detail::read_program_binary(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+
+    ProgramBinary program;
+    if (!file.read(reinterpret_cast<char*>(&program.format), sizeof(program.format))) return std::nullopt;
+
+    // Reading through the iterators never sets eofbit on the stream, so only a hard error means the read failed
+    program.binary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (file.bad() || program.binary.empty()) return std::nullopt;
+    return program;
+}
+}  // namespace engine
@@ -0,0 +1,102 @@
+#pragma once
+#include <OpenGL/gl3.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+///
+/// @brief Caches linked shader programs on disk (glGetProgramBinary/glProgramBinary), so they don't need to be
+/// compiled on every launch. Binaries are keyed by a hash of the shader sources and the driver (vendor, renderer and
+/// version), so a driver update naturally misses. If the driver rejects a binary anyway, it's deleted and the program
+/// is compiled from source.
+///
+/// NOTE: Some drivers (including macOS) don't support any binary formats, then the cache does nothing.
+///
+class ProgramCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+
+        // Binaries which were found but the driver refused to load (these also count as misses)
+        size_t rejected = 0;
+
+        // Total time spent in Shader::init() for hits and misses
+        std::chrono::nanoseconds hit_time{0};
+        std::chrono::nanoseconds miss_time{0};
+    };
+
+public:
+    ProgramCache();
+
+    ///
+    /// @brief Where binaries are stored, nullopt disables the cache. Defaults to engine/program_cache in the user's
+    /// cache directory ($XDG_CACHE_HOME, ~/Library/Caches on macOS or ~/.cache), disabled if there isn't one.
+    ///
+    void set_directory(std::optional<std::filesystem::path> directory);
+
+    ///
+    /// @brief Whether programs should be looked up and stored, requires a current context
+    ///
+    bool enabled();
+
+    uint64_t key(const std::string& vertex, const std::string& fragment, const std::optional<std::string>& geometry);
+
+    ///
+    /// @returns a linked program if a binary with this key was stored and the driver accepted it
+    ///
+    std::optional<GLuint> load(uint64_t key);
+
+    ///
+    /// @brief Save the binary of a linked program, which should have been linked with
+    /// GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+    ///
+    void store(uint64_t key, GLuint program);
+
+    void record_hit(std::chrono::nanoseconds duration);
+    void record_miss(std::chrono::nanoseconds duration);
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::filesystem::path path(uint64_t key) const;
+
+private:
+    std::optional<std::filesystem::path> directory_;
+
+    // Queried from the context the first time they're needed
+    std::optional<std::vector<GLint>> formats_;
+    std::optional<std::string> driver_;
+
+    Stats stats_;
+};
+
+///
+/// @brief The cache used by Shader::init()
+///
+ProgramCache& program_cache();
+
+namespace detail {
+struct ProgramBinary {
+    GLenum format = 0;
+    std::vector<char> binary;
+};
+
+///
+/// @brief Write a cache file: the format followed by the binary. It's written to a temporary file and renamed, so a
+/// partially written binary is never read.
+/// @returns false if the file couldn't be written, the temporary file is removed in that case
+///
+bool write_program_binary(const std::filesystem::path& path, const ProgramBinary& program);
+
+///
+/// @returns the contents of a cache file written by write_program_binary(), nullopt if it's missing or empty
+///
+std::optional<ProgramBinary> read_program_binary(const std::filesystem::path& path);
+}  // namespace detail
+}  // namespace engine
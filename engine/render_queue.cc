@@ -0,0 +1,78 @@
+#include "engine/render_queue.hh"
+
+#include <algorithm>
+#include <array>
+
+#include "engine/object_manager.hh"
+
+namespace engine {
+
+//
+// #############################################################################
+//
+
+uint64_t SortKey::pack() const {
+    constexpr uint64_t kDepthMax = (1 << 24) - 1;
+    const uint64_t quantized_depth = static_cast<uint64_t>(std::clamp(depth, 0.f, 1.f) * kDepthMax);
+
+    uint64_t key = static_cast<uint64_t>(std::min(layer, kMaxLayer)) << 57;
+    if (!translucent) {
+        return key | static_cast<uint64_t>(shader) << 40 | static_cast<uint64_t>(texture) << 24 | quantized_depth;
+    }
+
+    key |= uint64_t{1} << 56;
+    return key | (kDepthMax - quantized_depth) << 32 | static_cast<uint64_t>(shader) << 16 | texture;
+}
+
+//
+// #############################################################################
+//
+
+void RenderQueue::push(uint64_t key, AbstractObjectManager& manager, uint32_t id) {
+    commands_.push_back({key, &manager, id});
+}
+
+//
+// #############################################################################
+//
+
+void RenderQueue::sort() {
+    if (commands_.size() < 2) return;
+
+    // Find which bytes actually differ between keys, there's no need to sort by the others
+    uint64_t all_and = ~uint64_t{0};
+    uint64_t all_or = 0;
+    for (const Command& command : commands_) {
+        all_and &= command.key;
+        all_or |= command.key;
+    }
+    const uint64_t differing = all_and ^ all_or;
+
+    scratch_.resize(commands_.size());
+    for (size_t shift = 0; shift < 64; shift += 8) {
+        if (((differing >> shift) & 0xFF) == 0) continue;
+
+        std::array<size_t, 256> offsets{};
+        for (const Command& command : commands_) offsets[(command.key >> shift) & 0xFF]++;
+
+        size_t total = 0;
+        for (size_t& offset : offsets) {
+            const size_t count = offset;
+            offset = total;
+            total += count;
+        }
+
+        for (const Command& command : commands_) scratch_[offsets[(command.key >> shift) & 0xFF]++] = command;
+        commands_.swap(scratch_);
+    }
+}
+
+//
+// #############################################################################
+//
+
+void RenderQueue::execute(const Eigen::Matrix3f& screen_from_world) {
+    for (const Command& command : commands_) command.manager->execute(command.id, screen_from_world);
+    commands_.clear();
+}
+}  // namespace engine
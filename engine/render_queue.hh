@@ -0,0 +1,84 @@
+#pragma once
+#include <Eigen/Dense>
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+
+class AbstractObjectManager;
+
+///
+/// @brief The parts of a draw which determine the order it's executed in, see pack()
+///
+struct SortKey {
+    static constexpr uint8_t kMaxLayer = 127;
+
+    // Lower layers are drawn first (the background is layer 0)
+    uint8_t layer = 1;
+
+    // Translucent draws happen after the opaque draws in the same layer
+    bool translucent = false;
+
+    // Identify the state used by the draw, so draws using the same state end up next to each other
+    uint16_t shader = 0;
+    uint16_t texture = 0;
+
+    // Distance from the viewer, clamped to [0, 1] where 0 is the nearest
+    float depth = 0.f;
+
+    ///
+    /// @brief Pack everything into 64 bits, which sort in this order:
+    ///   opaque:      layer (7) | 0 | shader (16) | texture (16) | depth (24)
+    ///   translucent: layer (7) | 1 | inverted depth (24) | shader (16) | texture (16)
+    ///
+    /// Opaque draws are grouped by state and then drawn front to back so the depth test rejects hidden fragments.
+    /// Translucent draws have to be back to front to blend correctly, so depth takes priority over state there.
+    ///
+    uint64_t pack() const;
+};
+
+//
+// #############################################################################
+//
+
+///
+/// @brief Draw commands submitted by each object manager during a frame. Rather than managers drawing immediately,
+/// the commands from every manager are sorted by key and then executed, so state changes are minimized across
+/// managers.
+///
+class RenderQueue {
+public:
+    struct Command {
+        uint64_t key;
+        AbstractObjectManager* manager;
+
+        // Passed back to the manager, so it knows which of its draws to execute
+        uint32_t id;
+    };
+
+public:
+    void push(uint64_t key, AbstractObjectManager& manager, uint32_t id = 0);
+    void push(const SortKey& key, AbstractObjectManager& manager, uint32_t id = 0) { push(key.pack(), manager, id); }
+
+    ///
+    /// @brief Stable radix sort of the commands by key. Byte positions where every key is the same are skipped, which
+    /// is common since most frames only use a few layers, shaders and textures.
+    ///
+    void sort();
+
+    ///
+    /// @brief Run every command in the current order through AbstractObjectManager::execute(), then clear the queue
+    ///
+    void execute(const Eigen::Matrix3f& screen_from_world);
+
+    const std::vector<Command>& commands() const { return commands_; }
+    size_t size() const { return commands_.size(); }
+    void clear() { commands_.clear(); }
+
+private:
+    std::vector<Command> commands_;
+
+    // Sorting ping-pongs between these, kept around to avoid reallocating every frame
+    std::vector<Command> scratch_;
+};
+}  // namespace engine
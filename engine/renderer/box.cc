@@ -1,21 +1,35 @@
 #include "engine/renderer/box.hh"
 
+#include "engine/frame_uniforms.hh"
+
 namespace engine::renderer {
 namespace {
-static std::string vertex_shader_text = R"(
-#version 330
-uniform mat3 screen_from_world;
-layout (location = 0) in vec2 world_position;
-layout (location = 1) in vec3 in_uv;
+static std::string vertex_shader_text = std::string("#version 330\n") + kFrameUniformsGlsl + R"(
+layout (location = 0) in vec4 rect;
+layout (location = 1) in vec4 uv_rect;
+layout (location = 2) in vec2 rotation_alpha;
 
 out vec3 uv;
 
 void main()
 {
+    // The quad is drawn as a triangle strip: top left, top right, bottom left, bottom right
+    vec2 corner = vec2(gl_VertexID & 1, 1 - (gl_VertexID >> 1));
+
+    vec2 bottom_left = rect.xy;
+    vec2 dim = rect.zw;
+
+    // Rotate about the center of the box, inverted so that positive rotations go CW
+    float s = sin(-rotation_alpha.x);
+    float c = cos(-rotation_alpha.x);
+    vec2 from_center = (corner - 0.5) * dim;
+    vec2 world_position = bottom_left + 0.5 * dim + mat2(c, s, -s, c) * from_center;
+
     vec3 screen = screen_from_world * vec3(world_position.x, world_position.y, 1.0);
     gl_Position = vec4(screen.x, screen.y, 0.0, 1.0);
 
-    uv = in_uv;
+    // UVs start from the top left, so flip y
+    uv = vec3(uv_rect.xy + vec2(corner.x, 1.0 - corner.y) * uv_rect.zw, rotation_alpha.y);
 }
 )";
 
@@ -58,87 +72,75 @@ size_t BoxRenderer::add_texture(Texture texture) {
 
 void BoxRenderer::init() {
     shader_.init();
-    screen_from_world_loc_ = glGetUniformLocation(shader_.get_program_id(), "screen_from_world");
-
     vao_.init();
 
-    position_buffer_.init(GL_ARRAY_BUFFER, 0, vao_);
-    uv_buffer_.init(GL_ARRAY_BUFFER, 1, vao_);
+    // The corners of each quad are generated in the vertex shader, so the only data is per instance
+    instance_buffer_.init(GL_ARRAY_BUFFER, {{0, 4}, {1, 4}, {2, 2}}, vao_, 1);
+
+    // This is rewritten for every atlas page that's drawn
+    instance_buffer_.set_streaming();
 
-    position_buffer_.resize(4 * 2);
-    uv_buffer_.resize(4 * 3);
+    std::vector<const Bitmap*> bitmaps;
+    bitmaps.reserve(textures_.size());
+    for (const auto& texture : textures_) bitmaps.push_back(&texture.bitmap());
 
-    for (auto& texture : textures_) {
-        texture.init();
+    Atlas atlas = build_atlas(bitmaps);
+    placements_ = std::move(atlas.placements);
+
+    pages_.clear();
+    pages_.reserve(atlas.pages.size());
+    for (auto& page : atlas.pages) {
+        pages_.emplace_back(std::move(page)).init();
     }
+    pending_.resize(pages_.size());
 }
 
 //
 // #############################################################################
 //
 
-void BoxRenderer::draw(const Box& box, const Eigen::Matrix3f& screen_from_world) {
-    shader_.activate();
-    gl_check(glUniformMatrix3fv, screen_from_world_loc_, 1, GL_FALSE, screen_from_world.data());
+void BoxRenderer::submit(const Box& box) {
+    const AtlasPlacement& placement = placements_.at(box.texture_index);
+    const Bitmap& page = pages_[placement.page].bitmap();
 
-    auto& texture = textures_.at(box.texture_index);
-    texture.activate();
+    // Move the UV into the texture's spot in the atlas, then normalize it between 0 and 1
+    Eigen::Vector2f uv_size{page.get_width(), page.get_height()};
+    Eigen::Vector2f uv = (box.uv + Eigen::Vector2f{placement.x, placement.y}).cwiseQuotient(uv_size);
+    Eigen::Vector2f uv_dim = box.dim.cwiseQuotient(uv_size);
 
-    set_position(box.bottom_left, box.dim, box.rotation);
-
-    // The UV texture needs to be normalized between 0 and 1
-    Eigen::Vector2f uv_size{texture.bitmap().get_width(), texture.bitmap().get_height()};
-    set_uv(box.uv.cwiseQuotient(uv_size), box.dim.cwiseQuotient(uv_size), box.alpha.value_or(1.f));
-
-    gl_check_with_vao(vao_, glDrawArrays, GL_TRIANGLE_STRIP, 0, 4);
+    auto& instances = pending_[placement.page];
+    instances.insert(instances.end(), {box.bottom_left.x(), box.bottom_left.y(), box.dim.x(), box.dim.y(), uv.x(),
+                                       uv.y(), uv_dim.x(), uv_dim.y(), box.rotation.value_or(0.f),
+                                       box.alpha.value_or(1.f)});
 }
 
 //
 // #############################################################################
 //
 
-void BoxRenderer::set_uv(const Eigen::Vector2f& top_left, const Eigen::Vector2f& dim, float alpha) {
-    auto batch = uv_buffer_.batched_updater();
+void BoxRenderer::flush() {
+    shader_.activate();
+
+    for (size_t page = 0; page < pending_.size(); ++page) {
+        auto& instances = pending_[page];
+        if (instances.empty()) continue;
 
-    // I'm also storing the alpha of the object here
+        pages_[page].activate();
 
-    // top left
-    batch.element(0) = Eigen::Vector3f{top_left.x(), top_left.y(), alpha};
-    // top right
-    batch.element(1) = Eigen::Vector3f{top_left.x() + dim.x(), top_left.y(), alpha};
-    // bottom left
-    batch.element(2) = Eigen::Vector3f{top_left.x(), top_left.y() + dim.y(), alpha};
-    // bottom right
-    batch.element(3) = Eigen::Vector3f{top_left.x() + dim.x(), top_left.y() + dim.y(), alpha};
+        // Each group is streamed into the next spot in the ring, which re-points the attributes at it
+        instance_buffer_.batched_updater().assign(instances.begin(), instances.end());
+
+        gl_check_with_vao(vao_, glDrawArraysInstanced, GL_TRIANGLE_STRIP, 0, 4, instance_buffer_.elements());
+        instances.clear();
+    }
 }
 
 //
 // #############################################################################
 //
 
-void BoxRenderer::set_position(const Eigen::Vector2f& bottom_left, const Eigen::Vector2f& dim,
-                               const std::optional<float>& rotation) {
-    auto batch = position_buffer_.batched_updater();
-
-    Eigen::Matrix<float, 2, 4> coords;
-    coords << bottom_left + Eigen::Vector2f{0.f, dim.y()},  // top left
-        bottom_left + dim,                                  // top right
-        bottom_left,                                        // bottom left
-        bottom_left + Eigen::Vector2f{dim.x(), 0.f};        // bottom right
-
-    if (rotation) {
-        Eigen::Matrix2f r = Eigen::Matrix2f::Identity();
-        float s = std::sin(-*rotation);  // Invert so that positive rotations go CW
-        float c = std::cos(-*rotation);
-        r << c, -s, s, c;
-
-        // TODO: This can all be done with one matrix
-        Eigen::Matrix<float, 2, 1> center = bottom_left + 0.5 * dim;
-        for (int i = 0; i < coords.cols(); ++i) coords.col(i) -= center;
-        coords = r * coords;
-        for (int i = 0; i < coords.cols(); ++i) coords.col(i) += center;
-    }
-
-    batch.elements<4>(0) = coords;
+void BoxRenderer::draw(const Box& box) {
+    submit(box);
+    flush();
 }
 };  // namespace engine::renderer
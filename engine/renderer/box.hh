@@ -1,4 +1,5 @@
 #pragma once
+#include "engine/atlas.hh"
 #include "engine/buffer.hh"
 #include "engine/gl.hh"
 #include "engine/shader.hh"
@@ -29,25 +30,51 @@ public:
     BoxRenderer& operator=(BoxRenderer&&) = delete;
 
 public:
+    ///
+    /// @brief Add a texture which boxes can use through Box::texture_index. When init() is called all of the textures
+    /// are packed into a few atlas pages, so boxes using different textures can usually be drawn together. Box::uv is
+    /// still relative to the texture that was added, it's remapped to the atlas automatically.
+    ///
+    /// NOTE: Since textures share pages, a box's uv shouldn't extend past the edge of its texture.
+    ///
     size_t add_texture(Texture texture);
 
 public:
     void init();
-    void draw(const Box& box, const Eigen::Matrix3f& screen_from_world);
 
-private:
-    void set_uv(const Eigen::Vector2f& top_left, const Eigen::Vector2f& dim, float alpha);
-    void set_position(const Eigen::Vector2f& bottom_left, const Eigen::Vector2f& dim,
-                      const std::optional<float>& rotation);
+    ///
+    /// @brief Queue up a box to be drawn during the next flush(). No GL calls are made, so this can be called from
+    /// AbstractObjectManager::record() (as long as only one thread submits to this renderer).
+    ///
+    void submit(const Box& box);
+
+    ///
+    /// @brief Draw all of the submitted boxes, with one instanced draw call for each atlas page used. The camera comes
+    /// from the frame uniforms (see FrameUniformBuffer).
+    ///
+    void flush();
+
+    ///
+    /// @brief Draw a single box immediately, prefer submit() and flush() when drawing more than a few boxes
+    ///
+    void draw(const Box& box);
 
 private:
     engine::Shader shader_;
-    int screen_from_world_loc_;
+
+    // Each instance is: bottom left (2), dim (2), uv top left (2), uv dim (2), rotation (1) and alpha (1)
+    static constexpr size_t kInstanceStride = 10;
 
     engine::VertexArrayObject vao_;
-    engine::Buffer<float, 2> position_buffer_;
-    engine::Buffer<float, 3> uv_buffer_;
+    engine::Buffer<float, kInstanceStride> instance_buffer_;
 
     std::vector<Texture> textures_;
+
+    // The textures packed together, where each texture (by index) ended up in the atlas
+    std::vector<Texture> pages_;
+    std::vector<AtlasPlacement> placements_;
+
+    // The instances submitted since the last flush, grouped by atlas page
+    std::vector<std::vector<float>> pending_;
 };
 }  // namespace engine::renderer
@@ -4,112 +4,73 @@
 
 #include <iostream>
 
+#include "engine/frame_uniforms.hh"
 #include "engine/gl.hh"
+#include "engine/gl_state.hh"
 
 namespace engine::renderer {
 namespace {
-static std::string vertex_shader_text = R"(
-#version 330
-layout(location = 0) in vec2 world_position;
-uniform mat3 screen_from_world;
+static std::string vertex_shader_text = std::string("#version 330\n") + kFrameUniformsGlsl + R"(
+out vec2 world_position;
 
 void main()
 {
-    vec3 screen = screen_from_world * vec3(world_position.x, world_position.y, 1.0);
+    // A single triangle which covers the whole screen: (-1, -1), (3, -1), (-1, 3)
+    vec2 screen = vec2((gl_VertexID & 1) * 4.0 - 1.0, (gl_VertexID >> 1) * 4.0 - 1.0);
     gl_Position = vec4(screen.x, screen.y, 0.0, 1.0);
+
+    // The mapping is affine, so interpolating the world position is exact
+    world_position = (world_from_screen * vec3(screen.x, screen.y, 1.0)).xy;
 }
 )";
 
 static std::string fragment_shader_text = R"(
 #version 330
+uniform vec2 cell_dim;
+uniform float major_subdivisions;
+
+in vec2 world_position;
 out vec4 fragment;
 
-void main()
+// Coverage of the closest grid line with the given spacing, lines are one pixel wide with a one pixel falloff
+float grid_line(vec2 spacing, out float cell_pixels)
 {
-    fragment = vec4(0.3, 0.3, 0.3, 1.0);
-}
-)";
-
-static std::string geometry_shader_text = R"(
-#version 330 core
-layout (lines) in;
-layout (line_strip, max_vertices = 512) out;
+    vec2 coordinate = world_position / spacing;
 
-out float color;
+    // How many cells each pixel covers, this is what keeps the lines the same width at any zoom
+    vec2 cells_per_pixel = fwidth(coordinate);
+    cell_pixels = 1.0 / max(cells_per_pixel.x, cells_per_pixel.y);
 
-void vertical_line(float x) {
-    gl_Position = vec4(x, 1.0, 1.0, 1.0);
-    EmitVertex();
-    gl_Position = vec4(x, -1.0, 1.0, 1.0);
-    EmitVertex();
-    EndPrimitive();
+    vec2 pixels_from_line = abs(fract(coordinate - 0.5) - 0.5) / cells_per_pixel;
+    return 1.0 - clamp(min(pixels_from_line.x, pixels_from_line.y) - 0.5, 0.0, 1.0);
 }
 
-void horizontal_line(float y) {
-    gl_Position = vec4(1.0, y, 1.0, 1.0);
-    EmitVertex();
-    gl_Position = vec4(-1.0, y, 1.0, 1.0);
-    EmitVertex();
-    EndPrimitive();
-}
-
-float move_near_zero(float value, float step)
+void main()
 {
-    float diff = value;
-    while (diff >= step)
-        diff -= step;
-    while (diff < 0)
-        diff += step;
-    return diff;
-}
+    float minor_pixels;
+    float major_pixels;
+    float minor = grid_line(cell_dim, minor_pixels);
+    float major = grid_line(cell_dim * major_subdivisions, major_pixels);
 
-void main() {
-    float start_x = gl_in[0].gl_Position.x;
-    float end_x = gl_in[1].gl_Position.x;
-    float start_y = gl_in[0].gl_Position.y;
-    float end_y = gl_in[1].gl_Position.y;
-
-    float grid_width = end_x - start_x;
-    // Note: this will be negative since Y is inverted
-    float grid_height = abs(end_y - start_y);
-
-    start_x = move_near_zero(start_x, grid_width);
-    start_y = move_near_zero(start_y, grid_height);
-    vertical_line(start_x);
-    horizontal_line(start_y);
-
-    float positive_x = start_x;
-    float negative_x = start_x;
-    while (positive_x <= 1.5)
-    {
-        positive_x += grid_width;
-        negative_x -= grid_width;
-        vertical_line(positive_x);
-        vertical_line(negative_x);
-    }
-
-    float positive_y = start_y;
-    float negative_y = start_y;
-    while (positive_y <= 1.5)
-    {
-        positive_y += grid_height;
-        negative_y -= grid_height;
-        horizontal_line(positive_y);
-        horizontal_line(negative_y);
-    }
-
-    return;
-})";
+    // Fade lines out as they get too close together to be useful, rather than turning into noise
+    minor *= smoothstep(2.0, 8.0, minor_pixels);
+    major *= smoothstep(2.0, 8.0, major_pixels);
+
+    vec3 color = mix(vec3(0.3), vec3(0.5), major);
+    fragment = vec4(color, max(minor, major));
+}
+)";
 }  // namespace
 
 //
 // #############################################################################
 //
 
-Grid::Grid(const size_t grid_width, const size_t grid_height)
+Grid::Grid(const size_t grid_width, const size_t grid_height, const size_t major_subdivisions)
     : width_(grid_width),
       height_(grid_height),
-      shader_(vertex_shader_text, fragment_shader_text, geometry_shader_text) {}
+      major_subdivisions_(major_subdivisions),
+      shader_(vertex_shader_text, fragment_shader_text) {}
 
 //
 // #############################################################################
@@ -118,25 +79,42 @@ Grid::Grid(const size_t grid_width, const size_t grid_height)
 void Grid::init() {
     shader_.init();
     vao_.init();
-    buffer_.init(GL_ARRAY_BUFFER, 0, vao_);
-    auto buffer = buffer_.batched_updater();
-    buffer.push_back(0);        // x0
-    buffer.push_back(0);        // y0
-    buffer.push_back(width_);   // x1
-    buffer.push_back(height_);  // y1
-
-    screen_from_world_location_ = glGetUniformLocation(shader_.get_program_id(), "screen_from_world");
-    engine::throw_on_gl_error("glGetUniformLocation");
+
+    // These never change, so set them once
+    shader_.activate();
+    gl_check(glUniform2f, glGetUniformLocation(shader_.get_program_id(), "cell_dim"), width_, height_);
+    gl_check(glUniform1f, glGetUniformLocation(shader_.get_program_id(), "major_subdivisions"), major_subdivisions_);
 }
 
 //
 // #############################################################################
 //
 
-void Grid::render(const Eigen::Matrix3f& screen_from_world) {
+std::vector<engine::Shader*> Grid::shaders() { return {&shader_}; }
+
+//
+// #############################################################################
+//
+
+void Grid::render(const Eigen::Matrix3f&) {
+    // The camera comes from the frame uniforms
     shader_.activate();
-    gl_check(glUniformMatrix3fv, screen_from_world_location_, 1, GL_FALSE, screen_from_world.data());
-    gl_check_with_vao(vao_, glDrawArrays, GL_LINES, 0, 2);
+
+    // The grid is a background, it shouldn't hide anything drawn after it
+    gl_state().depth_mask(false);
+    gl_check_with_vao(vao_, glDrawArrays, GL_TRIANGLES, 0, 3);
+    gl_state().depth_mask(true);
+}
+
+//
+// #############################################################################
+//
+
+void Grid::submit(engine::RenderQueue& queue) {
+    // The grid is always the background, regardless of when it was added
+    engine::SortKey key;
+    key.layer = 0;
+    queue.push(key, *this);
 }
 
 //
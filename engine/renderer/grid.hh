@@ -3,9 +3,9 @@
 #include <filesystem>
 #include <vector>
 
-#include "engine/buffer.hh"
 #include "engine/object_manager.hh"
 #include "engine/shader.hh"
+#include "engine/vao.hh"
 
 namespace engine::renderer {
 
@@ -13,16 +13,25 @@ namespace engine::renderer {
 // #############################################################################
 //
 
+///
+/// @brief Draws an infinite grid behind everything else. The grid is evaluated per pixel in a single full screen pass,
+/// so the cost is the same at any zoom level. Every major_subdivisions cells a brighter major line is drawn, and lines
+/// fade out as they get too dense to see.
+///
 class Grid final : public engine::AbstractObjectManager {
 public:
-    Grid(const size_t grid_width, const size_t grid_height);
+    Grid(const size_t grid_width, const size_t grid_height, const size_t major_subdivisions = 5);
     virtual ~Grid() = default;
 
 protected:
     void init() override;
 
+    std::vector<engine::Shader*> shaders() override;
+
     void render(const Eigen::Matrix3f& screen_from_world) override;
 
+    void submit(engine::RenderQueue& queue) override;
+
 public:
     void update(float dt) override;
 
@@ -33,11 +42,11 @@ public:
 private:
     const size_t width_;
     const size_t height_;
-
-    int screen_from_world_location_;
+    const size_t major_subdivisions_;
 
     engine::Shader shader_;
+
+    // Nothing is stored in here, but drawing requires a VAO to be bound
     engine::VertexArrayObject vao_;
-    engine::Buffer<float, 2> buffer_;
 };
 }  // namespace engine::renderer
@@ -1,14 +1,21 @@
 #include "engine/renderer/line.hh"
 
+#include <algorithm>
+
+#include "engine/frame_uniforms.hh"
+
 namespace engine::renderer {
 namespace {
 static std::string vertex_shader_text = R"(
 #version 330
-layout (location = 0) in vec2 world_position;
+layout (location = 0) in vec3 point;
+
+out float point_thickness;
 
 void main()
 {
-    gl_Position = vec4(world_position.x, world_position.y, 0.0, 1.0);
+    gl_Position = vec4(point.x, point.y, 0.0, 1.0);
+    point_thickness = point.z;
 }
 )";
 
@@ -22,12 +29,11 @@ void main()
 }
 )";
 
-static std::string geometry_shader_text = R"(
-#version 330
+static std::string geometry_shader_text = std::string("#version 330\n") + kFrameUniformsGlsl + R"(
 layout(triangles) in;
 layout(triangle_strip, max_vertices = 10) out;
 
-uniform mat3 screen_from_world;
+in float point_thickness[];
 
 vec4 to_screen(vec2 world)
 {
@@ -37,7 +43,7 @@ vec4 to_screen(vec2 world)
 
 void main()
 {
-    float thickness = 0.25;
+    float thickness = point_thickness[0];
     vec2 start = gl_in[0].gl_Position.xy;
     vec2 end = gl_in[1].gl_Position.xy;
 
@@ -75,13 +81,56 @@ void main()
     EndPrimitive();
 }
 )";
+
+static std::string instanced_vertex_shader_text = std::string("#version 330\n") + kFrameUniformsGlsl + R"(
+// Each instance is a single segment, along with the point after it for the joint
+layout (location = 0) in vec4 start_end;
+layout (location = 1) in vec2 next;
+layout (location = 2) in float thickness;
+
+// The same triangles the geometry shader emits: the main section as two triangles, then the two halves of the end cap.
+// For each vertex: which point it's based on (0 start, 1 end), which normal is used (0 this segment, 1 next segment)
+// and which side of the line the vertex is on.
+const int kPoint[12] = int[12](0, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+const int kNormal[12] = int[12](0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0);
+const float kSide[12] = float[12](-1.0, -1.0, 1.0, 1.0, -1.0, 1.0, -1.0, -1.0, 0.0, 1.0, 1.0, 0.0);
+
+vec2 scaled_normal(vec2 from, vec2 to)
+{
+    vec2 direction = to - from;
+    return length(direction) > 0.0 ? thickness * normalize(vec2(-direction.y, direction.x)) : vec2(0.0);
+}
+
+void main()
+{
+    vec2 start = start_end.xy;
+    vec2 end = start_end.zw;
+
+    vec2 normal = scaled_normal(start, end);
+    vec2 next_normal = scaled_normal(end, next);
+
+    vec2 point = kPoint[gl_VertexID] == 0 ? start : end;
+    vec2 world = point + kSide[gl_VertexID] * (kNormal[gl_VertexID] == 0 ? normal : next_normal);
+
+    vec3 screen = screen_from_world * vec3(world.x, world.y, 1.0);
+    gl_Position = vec4(screen.x, screen.y, 0.0, 1.0);
+}
+)";
+
+// Vertices the instanced vertex shader generates for each segment
+constexpr int kInstancedVertices = 12;
+
+Shader make_shader(LineRenderer::Mode mode) {
+    if (mode == LineRenderer::Mode::kInstanced) return {instanced_vertex_shader_text, fragment_shader_text};
+    return {vertex_shader_text, fragment_shader_text, geometry_shader_text};
+}
 }  // namespace
 
 //
 // #############################################################################
 //
 
-LineRenderer::LineRenderer() : shader_(vertex_shader_text, fragment_shader_text, geometry_shader_text) {}
+LineRenderer::LineRenderer(Mode mode) : mode_(mode), shader_(make_shader(mode)) {}
 
 //
 // #############################################################################
@@ -89,66 +138,203 @@ LineRenderer::LineRenderer() : shader_(vertex_shader_text, fragment_shader_text,
 
 void LineRenderer::init() {
     shader_.init();
-    screen_from_world_loc_ = glGetUniformLocation(shader_.get_program_id(), "screen_from_world");
+    // Positions of the dynamic lines are rewritten every frame
+    init(dynamic_, true);
+    init(static_, false);
+    init(immediate_, true);
+}
 
-    vao_.init();
-    position_buffer_.init(GL_ARRAY_BUFFER, 0, vao_);
-    element_buffer_.init(GL_ELEMENT_ARRAY_BUFFER, vao_);
+//
+// #############################################################################
+//
+
+void LineRenderer::submit(const Line& line) {
+    // The geometry shader needs at least one full segment
+    if (line.segments.size() < 2) return;
+
+    append_points(line, pending_points_);
+    pending_sizes_.push_back(line.segments.size());
+}
+
+//
+// #############################################################################
+//
+
+size_t LineRenderer::add_static(Line line) {
+    static_lines_.emplace(next_static_id_, std::move(line));
+    static_dirty_ = true;
+    return next_static_id_++;
 }
 
 //
 // #############################################################################
 //
 
-void LineRenderer::draw(const Line& line, const Eigen::Matrix3f& screen_from_world) {
+void LineRenderer::remove_static(size_t id) { static_dirty_ |= static_lines_.erase(id) > 0; }
+
+//
+// #############################################################################
+//
+
+void LineRenderer::clear_static() {
+    static_dirty_ |= !static_lines_.empty();
+    static_lines_.clear();
+}
+
+//
+// #############################################################################
+//
+
+void LineRenderer::flush() {
     shader_.activate();
-    gl_check(glUniformMatrix3fv, screen_from_world_loc_, 1, GL_FALSE, screen_from_world.data());
 
-    set_position(line.segments);
-    set_elements(line.segments.size());
+    if (static_dirty_) {
+        std::vector<float> points;
+        std::vector<size_t> sizes;
+        for (const auto& [id, line] : static_lines_) {
+            if (line.segments.size() < 2) continue;
+            append_points(line, points);
+            sizes.push_back(line.segments.size());
+        }
+        upload(static_, points, sizes);
+        static_dirty_ = false;
+    }
+    draw(static_);
+
+    upload(dynamic_, pending_points_, pending_sizes_);
+    draw(dynamic_);
+    pending_points_.clear();
+    pending_sizes_.clear();
+}
 
-    // Each step will generate a triangle, so render 3 times as many
-    gl_check_with_vao(vao_, glDrawElements, GL_TRIANGLES, 3 * (line.segments.size() - 1), GL_UNSIGNED_INT, 0);
+//
+// #############################################################################
+//
+
+void LineRenderer::draw(const Line& line) {
+    if (line.segments.size() < 2) return;
+
+    // This has its own batch, so the static and submitted lines are left for flush()
+    std::vector<float> points;
+    append_points(line, points);
+
+    shader_.activate();
+    upload(immediate_, points, {line.segments.size()});
+    draw(immediate_);
 }
 
 //
 // #############################################################################
 //
 
-void LineRenderer::set_position(const std::vector<Eigen::Vector2f>& traced) {
-    auto batch = position_buffer_.batched_updater();
+void LineRenderer::init(Batch& batch, bool streaming) {
+    batch.vao.init();
 
-    size_t required_size = 2 * traced.size();
-    if (batch.size() < required_size) {
-        batch.resize(required_size);
+    if (mode_ == Mode::kInstanced) {
+        batch.segment_buffer.init(GL_ARRAY_BUFFER, {{0, 4}, {1, 2}, {2, 1}}, batch.vao, 1);
+        if (streaming) batch.segment_buffer.set_streaming();
+        return;
     }
 
-    for (size_t i = 0; i < traced.size(); ++i) {
-        batch.element(i) = traced[i];
+    batch.point_buffer.init(GL_ARRAY_BUFFER, 0, batch.vao);
+    batch.element_buffer.init(GL_ELEMENT_ARRAY_BUFFER, batch.vao);
+    if (streaming) batch.point_buffer.set_streaming();
+}
+
+//
+// #############################################################################
+//
+
+void LineRenderer::upload(Batch& batch, const std::vector<float>& points, const std::vector<size_t>& line_sizes) {
+    if (mode_ == Mode::kInstanced) {
+        std::vector<float> segments;
+        size_t first_point = 0;
+        for (size_t num_points : line_sizes) {
+            append_segments(points.data() + 3 * first_point, num_points, segments);
+            first_point += num_points;
+        }
+
+        if (!segments.empty()) batch.segment_buffer.batched_updater().assign(segments.begin(), segments.end());
+        batch.num_segments = segments.size() / Batch::kSegmentStride;
+        return;
+    }
+
+    if (!points.empty()) batch.point_buffer.batched_updater().assign(points.begin(), points.end());
+
+    // Most frames draw lines with the same number of points as the last, so the elements can be reused
+    if (line_sizes == batch.line_sizes) return;
+
+    std::vector<unsigned int> elements;
+    size_t first_point = 0;
+    for (size_t num_points : line_sizes) {
+        append_elements(first_point, num_points, elements);
+        first_point += num_points;
     }
+
+    if (!elements.empty()) batch.element_buffer.batched_updater().assign(elements.begin(), elements.end());
+    batch.num_elements = elements.size();
+    batch.line_sizes = line_sizes;
 }
 
 //
 // #############################################################################
 //
 
-void LineRenderer::set_elements(size_t num_segments) {
-    auto batch = element_buffer_.batched_updater();
+void LineRenderer::draw(Batch& batch) {
+    if (mode_ == Mode::kInstanced) {
+        if (batch.num_segments == 0) return;
+        gl_check_with_vao(batch.vao, glDrawArraysInstanced, GL_TRIANGLES, 0, kInstancedVertices, batch.num_segments);
+        return;
+    }
+
+    if (batch.num_elements == 0) return;
+    gl_check_with_vao(batch.vao, glDrawElements, GL_TRIANGLES, batch.num_elements, GL_UNSIGNED_INT, 0);
+}
 
-    size_t required_size = 3 * (num_segments - 1);
-    if (batch.size() < required_size) {
-        batch.resize(required_size);
+//
+// #############################################################################
+//
+
+void LineRenderer::append_points(const Line& line, std::vector<float>& points) {
+    for (const auto& point : line.segments) {
+        points.push_back(point.x());
+        points.push_back(point.y());
+        points.push_back(line.thickness);
     }
+}
 
-    size_t index = 0;
+//
+// #############################################################################
+//
 
-    for (size_t i = 0; i < num_segments - 1; ++i) {
-        batch[index++] = i;
-        batch[index++] = i + 1;
-        batch[index++] = i + 2;
+void LineRenderer::append_elements(size_t first_point, size_t num_points, std::vector<unsigned int>& elements) {
+    // Each step will generate a triangle (the segment along with the next point for the joint). The triangles of each
+    // line only reference that line's points, so lines can be packed back to back without any restart index.
+    for (size_t i = 0; i + 1 < num_points; ++i) {
+        elements.push_back(first_point + i);
+        elements.push_back(first_point + i + 1);
+        elements.push_back(first_point + i + 2);
     }
 
     // Replace the final element so that we don't have to duplicate a point in the vertex buffer
-    batch[index - 1] = num_segments - 1;
+    elements.back() = first_point + num_points - 1;
+}
+
+//
+// #############################################################################
+//
+
+void LineRenderer::append_segments(const float* points, size_t num_points, std::vector<float>& segments) {
+    // Points are stored as (x, y, thickness)
+    const auto point = [&](size_t i) { return points + 3 * std::min(i, num_points - 1); };
+
+    for (size_t i = 0; i + 1 < num_points; ++i) {
+        const float* start = point(i);
+        const float* end = point(i + 1);
+
+        // The last segment has no next point, the end cap collapses when the next point is the end itself
+        const float* next = point(i + 2);
+        segments.insert(segments.end(), {start[0], start[1], end[0], end[1], next[0], next[1], start[2]});
+    }
 }
 }  // namespace engine::renderer
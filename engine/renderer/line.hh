@@ -1,5 +1,6 @@
 #pragma once
 #include <Eigen/Dense>
+#include <map>
 #include <vector>
 
 #include "engine/buffer.hh"
@@ -10,6 +11,9 @@
 namespace engine::renderer {
 struct Line {
     std::vector<Eigen::Vector2f> segments;
+
+    // Half of the line width, in world units
+    float thickness = 0.25;
 };
 
 //
@@ -18,7 +22,15 @@ struct Line {
 
 class LineRenderer {
 public:
-    LineRenderer();
+    ///
+    /// @brief How thick lines are extruded from their points. Both produce the same triangles, the geometry shader
+    /// is the original path but it's slow on some drivers (Mesa/llvmpipe and many integrated GPUs), the instanced path
+    /// expands each segment in the vertex shader instead.
+    ///
+    enum class Mode { kGeometryShader, kInstanced };
+
+public:
+    LineRenderer(Mode mode = Mode::kGeometryShader);
 
     LineRenderer(const LineRenderer&) = delete;
     LineRenderer(LineRenderer&&) = delete;
@@ -27,18 +39,79 @@ public:
 
 public:
     void init();
-    void draw(const Line& line, const Eigen::Matrix3f& screen_from_world);
+
+    ///
+    /// @brief Queue up a line to be drawn during the next flush(). No GL calls are made, so this can be called from
+    /// AbstractObjectManager::record() (as long as only one thread submits to this renderer).
+    ///
+    void submit(const Line& line);
+
+    ///
+    /// @brief Add a line which is drawn on every flush() until it's removed. Static lines are only uploaded when the
+    /// set of static lines changes.
+    /// @returns an id which can be passed to remove_static()
+    ///
+    size_t add_static(Line line);
+    void remove_static(size_t id);
+    void clear_static();
+
+    ///
+    /// @brief Draw the static lines and every line submitted since the last flush, each set in a single draw call. The
+    /// camera comes from the frame uniforms (see FrameUniformBuffer).
+    ///
+    void flush();
+
+    ///
+    /// @brief Draw a single line immediately, without drawing the static or submitted lines. Each call is its own draw,
+    /// so prefer submit() and flush() when drawing more than a few lines.
+    ///
+    void draw(const Line& line);
 
 private:
-    void set_position(const std::vector<Eigen::Vector2f>& segments);
-    void set_elements(size_t num_segments);
+    ///
+    /// @brief Many lines packed into a single vertex and element stream
+    ///
+    struct Batch {
+        engine::VertexArrayObject vao;
+
+        // Used by Mode::kGeometryShader, each point is stored as (x, y, thickness)
+        engine::Buffer<float, 3> point_buffer;
+        engine::Buffer<unsigned int> element_buffer;
+
+        // Used by Mode::kInstanced, each segment is stored as start (2), end (2), next point (2) and thickness (1)
+        static constexpr size_t kSegmentStride = 7;
+        engine::Buffer<float, kSegmentStride> segment_buffer;
+
+        // Number of points in each line, the elements only depend on these so they're only rebuilt when this changes
+        std::vector<size_t> line_sizes;
+        size_t num_elements = 0;
+        size_t num_segments = 0;
+    };
+
+    void init(Batch& batch, bool streaming);
+    void upload(Batch& batch, const std::vector<float>& points, const std::vector<size_t>& line_sizes);
+    void draw(Batch& batch);
+
+    static void append_points(const Line& line, std::vector<float>& points);
+    static void append_elements(size_t first_point, size_t num_points, std::vector<unsigned int>& elements);
+    static void append_segments(const float* points, size_t num_points, std::vector<float>& segments);
 
 private:
+    const Mode mode_;
     engine::Shader shader_;
-    int screen_from_world_loc_;
 
-    engine::VertexArrayObject vao_;
-    engine::Buffer<float, 2> position_buffer_;
-    engine::Buffer<unsigned int> element_buffer_;
+    // Lines submitted this frame
+    Batch dynamic_;
+    std::vector<float> pending_points_;
+    std::vector<size_t> pending_sizes_;
+
+    // Lines which stay resident across frames
+    Batch static_;
+    std::map<size_t, Line> static_lines_;
+    size_t next_static_id_ = 0;
+    bool static_dirty_ = false;
+
+    // Used by draw(), rewritten for every line
+    Batch immediate_;
 };
 }  // namespace engine::renderer
@@ -1,42 +1,81 @@
 #include "engine/shader.hh"
 
 #include <OpenGL/gl3.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
 
+#include <array>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <utility>
 
+#include "engine/frame_uniforms.hh"
 #include "engine/gl.hh"
+#include "engine/gl_state.hh"
+#include "engine/program_cache.hh"
 
 namespace engine {
 namespace {
-int compile_shader(int type, const std::string& source) {
+// GL_COMPLETION_STATUS_KHR (and _ARB), defined here since the system headers may not have it
+constexpr GLenum kCompletionStatus = 0x91B1;
+
+unsigned submit_shader(int type, const std::string& source) {
     // Create an empty shader handle
-    int shader = glCreateShader(type);
+    unsigned shader = glCreateShader(type);
 
-    // Send the vertex shader source code to GL
+    // Send the source code to GL
     const char* data = source.c_str();
     glShaderSource(shader, 1, &data, 0);
 
-    // Compile the vertex shader
+    // Compile the shader, this may happen in the background so the status is checked later
     glCompileShader(shader);
+    return shader;
+}
 
+///
+/// @brief The info log of a shader which failed to compile, nullopt if it compiled
+///
+std::optional<std::string> compile_error(unsigned shader) {
     int compiled = 0;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (compiled == GL_FALSE) {
-        int length = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    if (compiled == GL_TRUE) return std::nullopt;
 
-        // The maxLength includes the NULL character
-        std::string log;
-        log.resize(length);
-        glGetShaderInfoLog(shader, length, &length, &log[0]);
+    int length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
 
-        // We don't need the shader anymore.
-        glDeleteShader(shader);
+    // The length includes the NULL character
+    std::string log;
+    log.resize(length);
+    glGetShaderInfoLog(shader, length, &length, &log[0]);
+    return log;
+}
 
-        throw std::runtime_error("Failed to compile " + std::to_string(type) + " shader: " + log);
-    }
-    return shader;
+///
+/// @brief Whether the driver can be asked if a compile is done without blocking. The first call also lets the driver
+/// use as many compiler threads as it wants.
+///
+bool parallel_compile_supported() {
+    static const bool supported = []() {
+        // The system headers may not declare the extension (the GL 4.1 headers on macOS don't), so the entry point is
+        // looked up at runtime. Both versions of the extension behave the same.
+        using MaxShaderCompilerThreads = void (*)(GLuint);
+        const std::array<std::pair<const char*, const char*>, 2> kExtensions{{
+            {"GL_KHR_parallel_shader_compile", "glMaxShaderCompilerThreadsKHR"},
+            {"GL_ARB_parallel_shader_compile", "glMaxShaderCompilerThreadsARB"},
+        }};
+        for (const auto& [extension, function] : kExtensions) {
+            if (!has_gl_extension(extension)) continue;
+
+            // Let the driver decide how many threads to use
+            if (auto max_threads = reinterpret_cast<MaxShaderCompilerThreads>(glfwGetProcAddress(function))) {
+                max_threads(0xFFFFFFFF);
+            }
+            return true;
+        }
+        return false;
+    }();
+    return supported;
 }
 }  // namespace
 
@@ -67,32 +106,90 @@ Shader::Shader(std::string vertex, std::string fragment, std::optional<std::stri
 //
 
 void Shader::init() {
-    int vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_);
-    int fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_);
-    if (vertex_shader < 0 || fragment_shader < 0) {
-        throw std::runtime_error("Failed to build at least one of the shaders.");
-    }
+    begin_init();
+    finish_init();
+}
 
-    // Vertex and fragment shaders are successfully compiled.
-    // Now time to link them together into a program_.
-    // Get a program_ object.
-    program_ = glCreateProgram();
+//
+// #############################################################################
+//
+
+void Shader::begin_init() {
+    if (program_ >= 0 || pending_) return;
+
+    PendingBuild& pending = pending_.emplace();
+    pending.start = Clock::now();
+
+    ProgramCache& cache = program_cache();
+    pending.use_cache = cache.enabled();
+    pending.key = pending.use_cache ? cache.key(vertex_, fragment_, geometry_) : 0;
 
-    // Attach our shaders to our program_
-    gl_check(glAttachShader, program_, vertex_shader);
-    gl_check(glAttachShader, program_, fragment_shader);
+    if (std::optional<GLuint> program = pending.use_cache ? cache.load(pending.key) : std::nullopt) {
+        program_ = *program;
+        pending.from_cache = true;
+        return;
+    }
 
-    int geometry_shader = 0;
-    if (geometry_) {
-        geometry_shader = compile_shader(GL_GEOMETRY_SHADER, *geometry_);
-        if (geometry_shader < 0) {
-            throw std::runtime_error("Failed to build geometry shader.");
+    try {
+        compile_and_link(pending.use_cache);
+    } catch (...) {
+        for (unsigned shader : pending.shaders) {
+            if (shader != 0) glDeleteShader(shader);
         }
-        gl_check(glAttachShader, program_, geometry_shader);
+        if (program_ >= 0) glDeleteProgram(program_);
+        program_ = -1;
+        pending_.reset();
+        throw;
     }
+}
 
-    // Link our program_
-    gl_check(glLinkProgram, program_);
+//
+// #############################################################################
+//
+
+bool Shader::is_ready() const {
+    if (!pending_ || pending_->from_cache) return true;
+
+    int done = GL_TRUE;
+    if (parallel_compile_supported()) glGetProgramiv(program_, kCompletionStatus, &done);
+    return done == GL_TRUE;
+}
+
+//
+// #############################################################################
+//
+
+void Shader::finish_init() {
+    begin_init();
+    if (!pending_) return;
+
+    const PendingBuild pending = *pending_;
+    pending_.reset();
+
+    ProgramCache& cache = program_cache();
+    if (pending.from_cache) {
+        cache.record_hit(Clock::now() - pending.start);
+        FrameUniformBuffer::bind_program(program_);
+        return;
+    }
+
+    auto delete_all = [&]() {
+        for (unsigned shader : pending.shaders) {
+            if (shader != 0) glDeleteShader(shader);
+        }
+        glDeleteProgram(program_);
+        program_ = -1;
+    };
+
+    // Checking any of these blocks until that part of the build is done
+    constexpr const char* kShaderTypes[] = {"vertex", "fragment", "geometry"};
+    for (size_t i = 0; i < pending.shaders.size(); ++i) {
+        if (pending.shaders[i] == 0) continue;
+        if (std::optional<std::string> log = compile_error(pending.shaders[i])) {
+            delete_all();
+            throw std::runtime_error(std::string("Failed to compile ") + kShaderTypes[i] + " shader: " + *log);
+        }
+    }
 
     // Note the different functions here: glGetProgram* instead of glGetShader*.
     int linked = 0;
@@ -106,18 +203,46 @@ void Shader::init() {
         glGetProgramInfoLog(program_, length, &length, &log[0]);
 
         // No need for program_ or shaders anymore
-        glDeleteProgram(program_);
-        glDeleteShader(vertex_shader);
-        glDeleteShader(fragment_shader);
-        if (geometry_) glDeleteShader(geometry_shader);
-
+        delete_all();
         throw std::runtime_error("Failed to link shaders: " + log);
     }
 
-    // Always detach shaders after a successful link.
-    gl_check(glDetachShader, program_, vertex_shader);
-    gl_check(glDetachShader, program_, fragment_shader);
-    if (geometry_) gl_check(glDetachShader, program_, geometry_shader);
+    // Always detach shaders after a successful link, they're only deleted once detached
+    for (unsigned shader : pending.shaders) {
+        if (shader == 0) continue;
+        gl_check(glDetachShader, program_, shader);
+        gl_check(glDeleteShader, shader);
+    }
+
+    if (pending.use_cache) cache.store(pending.key, program_);
+    cache.record_miss(Clock::now() - pending.start);
+
+    FrameUniformBuffer::bind_program(program_);
+}
+
+//
+// #############################################################################
+//
+
+void Shader::compile_and_link(bool retrievable) {
+    // Check this before anything is submitted, it sets how many threads the driver compiles with
+    parallel_compile_supported();
+
+    std::array<unsigned, 3>& shaders = pending_->shaders;
+    shaders[0] = submit_shader(GL_VERTEX_SHADER, vertex_);
+    shaders[1] = submit_shader(GL_FRAGMENT_SHADER, fragment_);
+    if (geometry_) shaders[2] = submit_shader(GL_GEOMETRY_SHADER, *geometry_);
+
+    // Link them together into a program_, this is also only submitted here. If a shader failed to compile, linking
+    // fails too and finish_init() reports the compile error.
+    program_ = glCreateProgram();
+    for (unsigned shader : shaders) {
+        if (shader != 0) gl_check(glAttachShader, program_, shader);
+    }
+
+    // The binary is only available after linking if it's requested beforehand
+    if (retrievable) gl_check(glProgramParameteri, program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    gl_check(glLinkProgram, program_);
 }
 
 //
@@ -128,7 +253,7 @@ void Shader::activate() const {
     if (program_ < 0) {
         throw std::runtime_error("Can't call Shader::activate() before Shader::init()");
     }
-    gl_check(glUseProgram, program_);
+    gl_state().use_program(program_);
 }
 
 //
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -13,15 +16,55 @@ public:
 public:
     Shader(std::string vertex, std::string fragment, std::optional<std::string> geometry = std::nullopt);
 
+    ///
+    /// @brief Build the program, blocking until it's done. This can also be split in two phases so the driver can
+    /// compile many programs at once: begin_init() submits the compile and link without waiting on them, is_ready()
+    /// polls without blocking and finish_init() checks the result. init() finishes whatever was already started.
+    ///
     void init();
+
+    void begin_init();
+    void finish_init();
+
+    ///
+    /// @brief Whether finish_init() won't block. Without KHR_parallel_shader_compile the driver can't be asked, so
+    /// this is always true and finish_init() waits instead.
+    ///
+    bool is_ready() const;
+
     void activate() const;
     int get_program_id() const;
 
 private:
+    ///
+    /// @brief Submit the compile and link of the program from source, the status is checked in finish_init()
+    /// @param retrievable whether the program binary will be retrieved after linking
+    ///
+    void compile_and_link(bool retrievable);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ///
+    /// @brief Everything needed by finish_init() for a build started by begin_init()
+    ///
+    struct PendingBuild {
+        Clock::time_point start;
+
+        // Program binary cache key, only used if the cache is enabled
+        bool use_cache = false;
+        uint64_t key = 0;
+        bool from_cache = false;
+
+        // Vertex, fragment and geometry shaders which still need to be checked, 0 if there isn't one
+        std::array<unsigned, 3> shaders{};
+    };
+
     std::string vertex_;
     std::string fragment_;
     std::optional<std::string> geometry_;
 
     int program_ = -1;
+    std::optional<PendingBuild> pending_;
 };
 }  // namespace engine
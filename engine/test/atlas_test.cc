@@ -0,0 +1,93 @@
+#include "engine/atlas.hh"
+
+#include <gtest/gtest.h>
+
+namespace engine {
+
+namespace {
+Bitmap solid(size_t width, size_t height, uint8_t value) {
+    return Bitmap{width, height, std::vector<Bitmap::Color>(width * height, Bitmap::Color{value, value, value, 0xFF})};
+}
+
+bool overlaps(const SkylinePacker::Position& lhs, size_t lhs_size, const SkylinePacker::Position& rhs,
+              size_t rhs_size) {
+    return lhs.x < rhs.x + rhs_size && rhs.x < lhs.x + lhs_size && lhs.y < rhs.y + rhs_size &&
+           rhs.y < lhs.y + lhs_size;
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(SkylinePacker, insert) {
+    SkylinePacker packer{64, 64};
+
+    // Sixteen 16x16 squares exactly fill the page
+    std::vector<SkylinePacker::Position> positions;
+    for (size_t i = 0; i < 16; ++i) {
+        auto position = packer.insert(16, 16);
+        ASSERT_TRUE(position);
+        EXPECT_LE(position->x + 16, 64);
+        EXPECT_LE(position->y + 16, 64);
+        for (const auto& other : positions) EXPECT_FALSE(overlaps(*position, 16, other, 16));
+        positions.push_back(*position);
+    }
+
+    EXPECT_FALSE(packer.insert(1, 1));
+}
+
+//
+// #############################################################################
+//
+
+TEST(SkylinePacker, too_large) {
+    SkylinePacker packer{64, 64};
+    EXPECT_FALSE(packer.insert(65, 1));
+    EXPECT_FALSE(packer.insert(1, 65));
+    EXPECT_TRUE(packer.insert(64, 64));
+}
+
+//
+// #############################################################################
+//
+
+TEST(Atlas, build_atlas) {
+    std::vector<Bitmap> bitmaps;
+    for (uint8_t i = 0; i < 200; ++i) bitmaps.push_back(solid(8 + i % 24, 8 + i % 13, i));
+
+    std::vector<const Bitmap*> pointers;
+    for (const auto& bitmap : bitmaps) pointers.push_back(&bitmap);
+
+    Atlas atlas = build_atlas(pointers, 256);
+    ASSERT_EQ(atlas.placements.size(), bitmaps.size());
+    EXPECT_LE(atlas.pages.size(), 3);
+
+    // Every pixel should have been copied to where the placement says
+    for (size_t i = 0; i < bitmaps.size(); ++i) {
+        const AtlasPlacement& placement = atlas.placements[i];
+        const Bitmap& page = atlas.pages.at(placement.page);
+        for (size_t row = 0; row < bitmaps[i].get_height(); ++row) {
+            for (size_t col = 0; col < bitmaps[i].get_width(); ++col) {
+                const auto& pixel = page.get_pixels()[(placement.y + row) * page.get_width() + placement.x + col];
+                ASSERT_EQ(pixel.blue, i);
+            }
+        }
+    }
+}
+
+//
+// #############################################################################
+//
+
+TEST(Atlas, oversized_bitmap) {
+    Bitmap large = solid(300, 20, 1);
+    Bitmap small = solid(4, 4, 2);
+
+    // The large bitmap gets a wider page, which still has room for the small one
+    Atlas atlas = build_atlas({&small, &large}, 128);
+    ASSERT_EQ(atlas.pages.size(), 1);
+    EXPECT_GE(atlas.pages[0].get_width(), 300);
+    EXPECT_EQ(atlas.pages[0].get_height(), 128);
+}
+}  // namespace engine
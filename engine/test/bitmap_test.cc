@@ -0,0 +1,140 @@
+#include "engine/bitmap.hh"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+
+namespace engine {
+
+namespace {
+///
+/// @brief Write a bitmap file with the given rows (in file order), each row is padded to 4 bytes
+///
+std::filesystem::path write_bitmap(const std::string& name, int32_t width, int32_t height, uint16_t bits_per_pixel,
+                                   const std::vector<std::vector<uint8_t>>& rows) {
+    const uint32_t row_bytes = (width * bits_per_pixel + 31) / 32 * 4;
+    const uint32_t offset = 14 + 40;
+    const uint32_t size = offset + row_bytes * rows.size();
+
+    std::vector<uint8_t> file;
+    auto write = [&file](auto value) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        file.insert(file.end(), bytes, bytes + sizeof(value));
+    };
+    write(uint16_t{19778});
+    write(size);
+    write(uint32_t{0});
+    write(offset);
+
+    write(uint32_t{40});
+    write(width);
+    write(height);
+    write(uint16_t{1});
+    write(bits_per_pixel);
+    for (size_t i = 0; i < 6; ++i) write(uint32_t{0});
+
+    for (std::vector<uint8_t> row : rows) {
+        row.resize(row_bytes, 0xAB);
+        file.insert(file.end(), row.begin(), row.end());
+    }
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), file.size());
+    return path;
+}
+
+void expect_color(const Bitmap::Color& color, uint8_t blue, uint8_t green, uint8_t red, uint8_t alpha) {
+    EXPECT_EQ(color.blue, blue);
+    EXPECT_EQ(color.green, green);
+    EXPECT_EQ(color.red, red);
+    EXPECT_EQ(color.alpha, alpha);
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(Bitmap, padded_rows_24_bit) {
+    // 3 pixels is 9 bytes per row, padded to 12. The bottom row is first in the file.
+    const auto path = write_bitmap("bitmap_test_24.bmp", 3, 2, 24,
+                                   {{1, 2, 3, 4, 5, 6, 7, 8, 9}, {10, 11, 12, 13, 14, 15, 16, 17, 18}});
+    Bitmap bitmap{path};
+
+    ASSERT_EQ(bitmap.get_width(), 3);
+    ASSERT_EQ(bitmap.get_height(), 2);
+    const auto& pixels = bitmap.get_pixels();
+    expect_color(pixels[0], 10, 11, 12, 0xFF);
+    expect_color(pixels[2], 16, 17, 18, 0xFF);
+    expect_color(pixels[3], 1, 2, 3, 0xFF);
+    expect_color(pixels[5], 7, 8, 9, 0xFF);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Bitmap, transparent_32_bit) {
+    const auto path = write_bitmap("bitmap_test_32.bmp", 2, 1, 32, {{1, 2, 3, 0, 4, 5, 6, 7}});
+    Bitmap bitmap{path};
+
+    // Fully transparent pixels have their color cleared
+    const auto& pixels = bitmap.get_pixels();
+    expect_color(pixels[0], 0, 0, 0, 0);
+    expect_color(pixels[1], 4, 5, 6, 7);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Bitmap, top_down) {
+    const auto path = write_bitmap("bitmap_test_top_down.bmp", 1, -2, 24, {{1, 2, 3}, {4, 5, 6}});
+    Bitmap bitmap{path};
+
+    ASSERT_EQ(bitmap.get_height(), 2);
+    expect_color(bitmap.get_pixels()[0], 1, 2, 3, 0xFF);
+    expect_color(bitmap.get_pixels()[1], 4, 5, 6, 0xFF);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Bitmap, truncated) {
+    // Claims two rows, but only has one
+    const auto path = write_bitmap("bitmap_test_truncated.bmp", 4, 2, 32, {{}});
+    EXPECT_THROW(Bitmap{path}, std::runtime_error);
+}
+
+//
+// #############################################################################
+//
+
+TEST(Bitmap, simd_matches_scalar) {
+    std::mt19937 generator{0};
+    std::uniform_int_distribution<int> byte{0, 255};
+
+    for (uint16_t bits_per_pixel : {24, 32}) {
+        for (size_t count = 0; count < 70; ++count) {
+            std::vector<uint8_t> source(count * bits_per_pixel / 8);
+            for (uint8_t& value : source) value = byte(generator);
+
+            // Make sure some of the pixels are transparent
+            if (bits_per_pixel == 32) {
+                for (size_t i = 3; i < source.size(); i += 12) source[i] = 0;
+            }
+
+            std::vector<Bitmap::Color> simd(count), scalar(count);
+            detail::convert_pixels(source.data(), simd.data(), count, bits_per_pixel, true);
+            detail::convert_pixels(source.data(), scalar.data(), count, bits_per_pixel, false);
+            for (size_t i = 0; i < count; ++i) {
+                SCOPED_TRACE(std::string(detail::pixel_conversion_name()) + " " + std::to_string(bits_per_pixel) +
+                             " bits, " + std::to_string(count) + " pixels, index " + std::to_string(i));
+                expect_color(simd[i], scalar[i].blue, scalar[i].green, scalar[i].red, scalar[i].alpha);
+            }
+        }
+    }
+}
+}  // namespace engine
@@ -0,0 +1,69 @@
+#include "engine/object_global.hh"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <stdexcept>
+
+namespace engine {
+
+namespace {
+///
+/// @brief Records on a worker thread, but only once the test allows it to
+///
+class BlockingManager final : public AbstractObjectManager {
+public:
+    void init() override {}
+    void record(const Eigen::Matrix3f& screen_from_world) override {
+        allowed.get_future().wait();
+        if (fail) throw std::runtime_error("record failed");
+        recorded = screen_from_world(0, 0);
+    }
+    void render(const Eigen::Matrix3f&) override { rendered = recorded; }
+    void update(float) override {}
+    void handle_mouse_event(const MouseEvent&) override {}
+    void handle_keyboard_event(const KeyboardEvent&) override {}
+
+    std::promise<void> allowed;
+    bool fail = false;
+    float recorded = 0.f;
+    float rendered = 0.f;
+};
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(GlobalObjectManager, record_overlaps_until_render) {
+    auto manager = std::make_shared<BlockingManager>();
+    GlobalObjectManager global;
+    global.add_manager(manager);
+
+    // record() has to return while the manager is still recording, otherwise this would never finish
+    const Eigen::Matrix3f screen_from_world = 2.f * Eigen::Matrix3f::Identity();
+    global.record(screen_from_world);
+    manager->allowed.set_value();
+
+    // render() waits for the recording to be done before drawing
+    global.render(screen_from_world);
+    EXPECT_EQ(manager->rendered, 2.f);
+}
+
+//
+// #############################################################################
+//
+
+TEST(GlobalObjectManager, record_exception) {
+    auto manager = std::make_shared<BlockingManager>();
+    manager->fail = true;
+    manager->allowed.set_value();
+
+    GlobalObjectManager global;
+    global.add_manager(manager);
+
+    global.record(Eigen::Matrix3f::Identity());
+    EXPECT_THROW(global.render(Eigen::Matrix3f::Identity()), std::runtime_error);
+    EXPECT_EQ(manager->rendered, 0.f);
+}
+}  // namespace engine
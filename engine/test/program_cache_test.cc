@@ -0,0 +1,72 @@
+#include "engine/program_cache.hh"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+namespace engine {
+
+namespace {
+std::filesystem::path cache_file(const std::string& name) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path;
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(ProgramCache, round_trip) {
+    const auto path = cache_file("program_cache_test_round_trip.bin");
+
+    detail::ProgramBinary program;
+    program.format = 0x8E21;
+    program.binary = {'\0', 'b', 'i', 'n', '\xFF', '\n', 'y'};
+    ASSERT_TRUE(detail::write_program_binary(path, program));
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    EXPECT_FALSE(std::filesystem::exists(temporary));
+
+    const auto loaded = detail::read_program_binary(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->format, program.format);
+    EXPECT_EQ(loaded->binary, program.binary);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ProgramCache, missing_or_empty) {
+    const auto path = cache_file("program_cache_test_empty.bin");
+    EXPECT_FALSE(detail::read_program_binary(path));
+
+    // Only a format, but no binary
+    detail::ProgramBinary program;
+    program.format = 1;
+    ASSERT_TRUE(detail::write_program_binary(path, program));
+    EXPECT_FALSE(detail::read_program_binary(path));
+
+    // Not even a full format
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write("ab", 2);
+    EXPECT_FALSE(detail::read_program_binary(path));
+}
+
+//
+// #############################################################################
+//
+
+TEST(ProgramCache, write_failure) {
+    // The parent directory doesn't exist, so neither the file nor the temporary file can be created
+    const auto path = std::filesystem::temp_directory_path() / "program_cache_test_missing" / "program.bin";
+    std::filesystem::remove_all(path.parent_path());
+
+    detail::ProgramBinary program;
+    program.binary = {'x'};
+    EXPECT_FALSE(detail::write_program_binary(path, program));
+    EXPECT_FALSE(std::filesystem::exists(path.parent_path()));
+}
+}  // namespace engine
@@ -0,0 +1,109 @@
+#include "engine/render_queue.hh"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "engine/object_manager.hh"
+
+namespace engine {
+
+namespace {
+class RecordingManager final : public AbstractObjectManager {
+public:
+    void init() override {}
+    void render(const Eigen::Matrix3f&) override {}
+    void update(float) override {}
+    void handle_mouse_event(const MouseEvent&) override {}
+    void handle_keyboard_event(const KeyboardEvent&) override {}
+
+    void execute(uint32_t id, const Eigen::Matrix3f&) override { executed.push_back(id); }
+
+    std::vector<uint32_t> executed;
+};
+
+SortKey opaque(uint16_t shader, uint16_t texture, float depth) {
+    SortKey key;
+    key.shader = shader;
+    key.texture = texture;
+    key.depth = depth;
+    return key;
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TEST(SortKey, pack) {
+    // State first, then front to back
+    EXPECT_LT(opaque(1, 1, 0.9).pack(), opaque(1, 2, 0.1).pack());
+    EXPECT_LT(opaque(1, 2, 0.1).pack(), opaque(2, 1, 0.1).pack());
+    EXPECT_LT(opaque(1, 1, 0.1).pack(), opaque(1, 1, 0.9).pack());
+
+    // Translucent after opaque and back to front
+    SortKey near = opaque(1, 1, 0.1);
+    near.translucent = true;
+    SortKey far = opaque(2, 2, 0.9);
+    far.translucent = true;
+    EXPECT_LT(opaque(9, 9, 1.0).pack(), far.pack());
+    EXPECT_LT(far.pack(), near.pack());
+
+    // Layers before everything else
+    SortKey background = far;
+    background.layer = 0;
+    EXPECT_LT(background.pack(), opaque(0, 0, 0.0).pack());
+}
+
+//
+// #############################################################################
+//
+
+TEST(RenderQueue, sort) {
+    RecordingManager manager;
+    RenderQueue queue;
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<uint64_t> distribution;
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        // Only a few distinct values in the low bits to make sure the sort is stable
+        keys.push_back((distribution(generator) & 0xFF00FF0000000000) | i % 7);
+        queue.push(keys.back(), manager, i);
+    }
+
+    std::vector<uint32_t> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    const auto compare = [&](uint32_t lhs, uint32_t rhs) { return keys[lhs] < keys[rhs]; };
+    std::stable_sort(expected.begin(), expected.end(), compare);
+
+    queue.sort();
+    queue.execute(Eigen::Matrix3f::Identity());
+    EXPECT_EQ(manager.executed, expected);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+//
+// #############################################################################
+//
+
+TEST(RenderQueue, same_key_keeps_order) {
+    RecordingManager first;
+    RecordingManager second;
+    RenderQueue queue;
+
+    queue.push(SortKey{}, first, 0);
+    queue.push(SortKey{}, second, 1);
+    SortKey background;
+    background.layer = 0;
+    queue.push(background, second, 2);
+
+    queue.sort();
+    ASSERT_EQ(queue.commands().size(), 3);
+    EXPECT_EQ(queue.commands()[0].id, 2);
+    EXPECT_EQ(queue.commands()[1].manager, &first);
+    EXPECT_EQ(queue.commands()[2].id, 1);
+}
+}  // namespace engine
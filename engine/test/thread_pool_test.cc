@@ -0,0 +1,49 @@
+#include "engine/thread_pool.hh"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+namespace engine {
+
+//
+// #############################################################################
+//
+
+TEST(ThreadPool, submit) {
+    ThreadPool pool{4};
+    EXPECT_EQ(pool.size(), 4);
+
+    std::vector<std::future<size_t>> results;
+    for (size_t i = 0; i < 100; ++i) results.push_back(pool.submit([i]() { return i * i; }));
+
+    for (size_t i = 0; i < results.size(); ++i) EXPECT_EQ(results[i].get(), i * i);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ThreadPool, exception) {
+    ThreadPool pool{1};
+    auto result = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+
+    // The worker should still be alive
+    EXPECT_EQ(pool.submit([]() { return 5; }).get(), 5);
+}
+
+//
+// #############################################################################
+//
+
+TEST(ThreadPool, finishes_queued_tasks) {
+    std::atomic<size_t> count = 0;
+    {
+        ThreadPool pool{2};
+        for (size_t i = 0; i < 1000; ++i) pool.submit([&count]() { count++; });
+    }
+    EXPECT_EQ(count, 1000);
+}
+}  // namespace engine
@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "engine/gl.hh"
+#include "engine/gl_state.hh"
 
 namespace engine {
 
@@ -16,9 +17,15 @@ Texture::Texture(const std::filesystem::path& texture) : id_(-1), bitmap_(textur
 // #############################################################################
 //
 
+Texture::Texture(Bitmap bitmap) : id_(-1), bitmap_(std::move(bitmap)) {}
+
+//
+// #############################################################################
+//
+
 void Texture::init() {
     gl_check(glGenTextures, 1, &id_);
-    gl_check(glBindTexture, GL_TEXTURE_2D, id_);
+    gl_state().bind_texture(GL_TEXTURE_2D, id_);
     gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -33,12 +40,13 @@ void Texture::init() {
 // #############################################################################
 //
 
-void Texture::activate() {
+void Texture::activate(size_t unit) {
     if (id_ < 0) {
         throw std::runtime_error("Texture not initialized, did you call Texture::init()?");
     }
 
-    gl_check(glBindTexture, GL_TEXTURE_2D, id_);
+    gl_state().active_texture(unit);
+    gl_state().bind_texture(GL_TEXTURE_2D, id_);
 }
 
 //
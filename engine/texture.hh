@@ -13,9 +13,10 @@ namespace engine {
 class Texture {
 public:
     Texture(const std::filesystem::path& texture);
+    Texture(Bitmap bitmap);
 
     void init();
-    void activate();
+    void activate(size_t unit = 0);
 
     const Bitmap& bitmap() const;
 
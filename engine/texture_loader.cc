@@ -0,0 +1,189 @@
+#include "engine/texture_loader.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "engine/gl.hh"
+#include "engine/gl_state.hh"
+
+namespace engine {
+namespace {
+GLuint create_texture(size_t width, size_t height, const void* pixels) {
+    // Otherwise the pixels would be read from the bound pixel buffer
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    GLuint id = 0;
+    gl_check(glGenTextures, 1, &id);
+    gl_state().bind_texture(GL_TEXTURE_2D, id);
+    gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl_check(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    // Without pixels this only allocates the storage
+    gl_check(glTexImage2D, GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+    return id;
+}
+}  // namespace
+
+//
+// #############################################################################
+//
+
+TextureLoader::TextureLoader(size_t bytes_per_frame) : bytes_per_frame_(bytes_per_frame) {}
+
+//
+// #############################################################################
+//
+
+void TextureLoader::init(const Bitmap& placeholder) {
+    placeholder_ = create_texture(placeholder.get_width(), placeholder.get_height(), placeholder.get_pixels().data());
+    gl_check(glGenBuffers, 1, &pixel_buffer_);
+}
+
+//
+// #############################################################################
+//
+
+auto TextureLoader::load(const std::filesystem::path& path) -> Handle {
+    if (!pool_) pool_ = std::make_unique<ThreadPool>();
+
+    Entry& entry = entries_.emplace_back();
+    entry.path = path;
+    entry.decoding = pool_->submit([path]() { return Bitmap{path}; });
+
+    pending_.push_back(entries_.size() - 1);
+    return entries_.size() - 1;
+}
+
+//
+// #############################################################################
+//
+
+void TextureLoader::update() {
+    if (pending_.empty()) return;
+    if (placeholder_ == 0) {
+        throw std::runtime_error("TextureLoader not initialized, did you call TextureLoader::init()?");
+    }
+
+    size_t budget = bytes_per_frame_;
+    size_t uploaded = 0;
+    for (auto it = pending_.begin(); it != pending_.end() && budget > 0;) {
+        Entry& entry = entries_[*it];
+
+        if (!entry.bitmap) {
+            // Textures which are still decoding are skipped, so one large texture doesn't hold up the rest
+            if (entry.decoding.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+
+            try {
+                entry.bitmap.emplace(entry.decoding.get());
+            } catch (const std::exception& e) {
+                // This one is never going to be ready, it'll keep using the placeholder
+                pending_.erase(it);
+                gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                throw std::runtime_error("Failed to load texture " + entry.path.string() + ": " + e.what());
+            }
+            entry.id = create_texture(entry.bitmap->get_width(), entry.bitmap->get_height(), nullptr);
+        }
+
+        const size_t bytes = upload_rows(entry, budget);
+        budget -= std::min(budget, bytes);
+        uploaded += bytes;
+
+        if (entry.rows_uploaded < entry.bitmap->get_height()) continue;
+
+        entry.ready = true;
+        entry.bitmap.reset();
+        stats_.textures++;
+        it = pending_.erase(it);
+    }
+
+    // Leaving it bound would make any other glTexImage2D() read from it
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    stats_.bytes += uploaded;
+    if (uploaded > 0) stats_.frames++;
+}
+
+//
+// #############################################################################
+//
+
+size_t TextureLoader::upload_rows(Entry& entry, size_t budget) {
+    const Bitmap& bitmap = *entry.bitmap;
+    const size_t width = bitmap.get_width();
+    const size_t row_bytes = width * sizeof(Bitmap::Color);
+    const size_t remaining = bitmap.get_height() - entry.rows_uploaded;
+
+    // Always make some progress, even if a single row is larger than the budget
+    const size_t rows = std::min(remaining, std::max<size_t>(1, budget / std::max<size_t>(1, row_bytes)));
+    const size_t bytes = rows * row_bytes;
+    if (bytes == 0) {
+        entry.rows_uploaded += rows;
+        return 0;
+    }
+
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+
+    // Orphan the previous contents, so this doesn't wait for an earlier upload which is still reading from them
+    gl_check(glBufferData, GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    constexpr GLbitfield kAccess = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, kAccess);
+    if (destination == nullptr) throw_on_gl_error("glMapBufferRange");
+    std::memcpy(destination, bitmap.get_pixels().data() + entry.rows_uploaded * width, bytes);
+    gl_check(glUnmapBuffer, GL_PIXEL_UNPACK_BUFFER);
+
+    // With a pixel buffer bound the last argument is an offset into it, so the copy into the texture can happen later
+    gl_state().bind_texture(GL_TEXTURE_2D, entry.id);
+    gl_check(glTexSubImage2D, GL_TEXTURE_2D, 0, 0, entry.rows_uploaded, width, rows, GL_BGRA, GL_UNSIGNED_BYTE,
+             nullptr);
+
+    entry.rows_uploaded += rows;
+    return bytes;
+}
+
+//
+// #############################################################################
+//
+
+void TextureLoader::activate(Handle handle, size_t unit) const {
+    if (placeholder_ == 0) {
+        throw std::runtime_error("TextureLoader not initialized, did you call TextureLoader::init()?");
+    }
+
+    const Entry& entry = entries_.at(handle);
+    gl_state().active_texture(unit);
+    gl_state().bind_texture(GL_TEXTURE_2D, entry.ready ? entry.id : placeholder_);
+}
+
+//
+// #############################################################################
+//
+
+bool TextureLoader::ready(Handle handle) const { return entries_.at(handle).ready; }
+
+//
+// #############################################################################
+//
+
+size_t TextureLoader::num_pending() const { return pending_.size(); }
+
+//
+// #############################################################################
+//
+
+void TextureLoader::set_bytes_per_frame(size_t bytes_per_frame) { bytes_per_frame_ = bytes_per_frame; }
+
+//
+// #############################################################################
+//
+
+TextureLoader& texture_loader() {
+    static TextureLoader loader;
+    return loader;
+}
+}  // namespace engine
@@ -0,0 +1,122 @@
+#pragma once
+#include <OpenGL/gl3.h>
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "engine/bitmap.hh"
+#include "engine/thread_pool.hh"
+
+namespace engine {
+
+///
+/// @brief Loads textures without stalling the render thread. Bitmaps are decoded on a thread pool, then uploaded
+/// through a pixel buffer object a few rows at a time, so no frame uploads more than the per-frame byte budget. Until a
+/// texture is fully uploaded, activating it binds a placeholder instead.
+///
+/// Usage:
+///   // From the GL thread, after init()
+///   TextureLoader::Handle handle = texture_loader().load("sprite.bmp");
+///
+///   // Each frame (Window does this), then when drawing
+///   texture_loader().update();
+///   texture_loader().activate(handle);
+///
+/// NOTE: Everything except the decoding happens on the thread which owns the GL context. Textures are never deleted,
+/// they're released along with the context.
+///
+class TextureLoader {
+public:
+    using Handle = size_t;
+
+    static constexpr size_t kDefaultBytesPerFrame = 4 * 1024 * 1024;
+
+    struct Stats {
+        size_t textures = 0;
+        size_t bytes = 0;
+
+        // Frames which uploaded anything
+        size_t frames = 0;
+    };
+
+public:
+    explicit TextureLoader(size_t bytes_per_frame = kDefaultBytesPerFrame);
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    ///
+    /// @brief Create the placeholder texture and the pixel buffer, requires a current context
+    ///
+    void init(const Bitmap& placeholder = Bitmap{1, 1, {Bitmap::Color{0x80, 0x80, 0x80, 0xFF}}});
+
+    ///
+    /// @brief Start decoding the bitmap in the background, the handle can be activated right away
+    ///
+    Handle load(const std::filesystem::path& path);
+
+    ///
+    /// @brief Upload decoded textures until this frame's budget is spent, should be called once per frame. At least
+    /// one row is uploaded per frame even if a row is larger than the budget. Decoding errors are rethrown from here.
+    ///
+    void update();
+
+    ///
+    /// @brief Bind the texture if it's been fully uploaded, otherwise the placeholder
+    ///
+    void activate(Handle handle, size_t unit = 0) const;
+
+    bool ready(Handle handle) const;
+
+    ///
+    /// @brief How many textures are still being decoded or uploaded
+    ///
+    size_t num_pending() const;
+
+    void set_bytes_per_frame(size_t bytes_per_frame);
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        std::filesystem::path path;
+        std::future<Bitmap> decoding;
+
+        // Set once decoding is done, and released once everything is uploaded
+        std::optional<Bitmap> bitmap;
+        size_t rows_uploaded = 0;
+
+        GLuint id = 0;
+        bool ready = false;
+    };
+
+    ///
+    /// @brief Copy as many rows of the entry as fit in the budget into the pixel buffer and upload them from there
+    /// @returns how many bytes were uploaded
+    ///
+    size_t upload_rows(Entry& entry, size_t budget);
+
+private:
+    size_t bytes_per_frame_;
+
+    GLuint placeholder_ = 0;
+    GLuint pixel_buffer_ = 0;
+
+    std::vector<Entry> entries_;
+
+    // Handles which aren't ready yet, in the order they were loaded
+    std::vector<Handle> pending_;
+
+    // Decodes the bitmaps, created on first use
+    std::unique_ptr<ThreadPool> pool_;
+
+    Stats stats_;
+};
+
+///
+/// @brief The loader updated by Window each frame
+///
+TextureLoader& texture_loader();
+}  // namespace engine
@@ -0,0 +1,58 @@
+#include "engine/thread_pool.hh"
+
+#include <algorithm>
+
+namespace engine {
+
+//
+// #############################################################################
+//
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) workers_.emplace_back([this]() { work(); });
+}
+
+//
+// #############################################################################
+//
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    // Workers finish everything that's been queued before exiting
+    for (auto& worker : workers_) worker.join();
+}
+
+//
+// #############################################################################
+//
+
+size_t ThreadPool::default_num_threads() {
+    const size_t hardware = std::thread::hardware_concurrency();
+    return std::max<size_t>(hardware, 2) - 1;
+}
+
+//
+// #############################################################################
+//
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex_};
+            condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;  // only when stopping
+
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+}  // namespace engine
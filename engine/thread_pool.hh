@@ -0,0 +1,65 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace engine {
+
+///
+/// @brief A fixed set of worker threads which run submitted tasks in the order they were submitted
+///
+class ThreadPool {
+public:
+    ///
+    /// @param num_threads how many workers to start, by default one less than the hardware concurrency (leaving a core
+    /// for the GL thread) but at least one
+    ///
+    explicit ThreadPool(size_t num_threads = default_num_threads());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+public:
+    ///
+    /// @brief Queue up a task, any exception it throws is rethrown from the future's get()
+    ///
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> submit(Function&& function) {
+        using Result = std::invoke_result_t<Function>;
+
+        // std::function has to be copyable, which std::packaged_task isn't
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard lock{mutex_};
+            tasks_.emplace([task]() { (*task)(); });
+        }
+        condition_.notify_one();
+        return result;
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    static size_t default_num_threads();
+
+private:
+    void work();
+
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::queue<std::function<void()>> tasks_;
+    bool stopping_ = false;
+};
+}  // namespace engine
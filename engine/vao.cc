@@ -1,6 +1,7 @@
 #include "engine/vao.hh"
 
 #include "engine/gl.hh"
+#include "engine/gl_state.hh"
 
 namespace engine {
 
@@ -14,7 +15,10 @@ VertexArrayObject::ScopedBinder::ScopedBinder(const VertexArrayObject& parent) :
 // #############################################################################
 //
 
-VertexArrayObject::ScopedBinder::~ScopedBinder() { parent_.unbind(); }
+VertexArrayObject::ScopedBinder::~ScopedBinder() {
+    // Intentionally not unbinding, the VAO stays bound until another is needed since the state cache will skip the
+    // bind if the same VAO is used next
+}
 
 //
 // #############################################################################
@@ -22,6 +26,7 @@ VertexArrayObject::ScopedBinder::~ScopedBinder() { parent_.unbind(); }
 
 VertexArrayObject::~VertexArrayObject() {
     if (handle_) {
+        gl_state().on_delete_vertex_array(*handle_);
         glDeleteVertexArrays(1, &*handle_);
     }
 }
@@ -41,14 +46,14 @@ void VertexArrayObject::init() {
 
 void VertexArrayObject::bind() const {
     if (!handle_) throw std::runtime_error("VertexArrayObject::bind() called before VertexArrayObject::init()");
-    gl_check(glBindVertexArray, *handle_);
+    gl_state().bind_vertex_array(*handle_);
 }
 
 //
 // #############################################################################
 //
 
-void VertexArrayObject::unbind() const { gl_check(glBindVertexArray, 0); }
+void VertexArrayObject::unbind() const { gl_state().bind_vertex_array(0); }
 
 //
 // #############################################################################
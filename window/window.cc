@@ -1,6 +1,9 @@
 #include "window/window.hh"
 
 #include "engine/gl.hh"
+#include "engine/gl_state.hh"
+#include "engine/program_cache.hh"
+#include "engine/texture_loader.hh"
 
 namespace engine {
 template <typename Repr, typename Period>
@@ -72,18 +75,38 @@ void Window::init() {
     // glfwSwapInterval(0);
 
     setup_glfw_callbacks(window_);
+    init_gl_checks();
 
     std::cout << "GL_SHADING_LANGUAGE_VERSION: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << "\n";
     std::cout << "GL_VERSION: " << glGetString(GL_VERSION) << "\n";
 
-    gl_check(glEnable, GL_BLEND);
-    gl_check(glBlendFunc, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    gl_check(glEnable, GL_DEPTH_TEST);
-    gl_check(glDepthMask, GL_TRUE);
-    gl_check(glDepthFunc, GL_LEQUAL);
+    gl_state().invalidate();
+    gl_state().enable(GL_BLEND);
+    gl_state().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state().enable(GL_DEPTH_TEST);
+    gl_state().depth_mask(true);
+    gl_state().depth_func(GL_LEQUAL);
     gl_check(glDepthRange, 0.0f, 1.0f);
 
+    frame_uniforms_.init();
+    texture_loader().init();
+
+    // Shaders are compiled while this runs, keep the window responsive and show how far along it is
+    loading_ = true;
+    object_manager_.set_loading_callback([this](size_t ready, size_t total) {
+        const std::string title = "Loading shaders (" + std::to_string(ready) + "/" + std::to_string(total) + ")";
+        glfwSetWindowTitle(window_, title.c_str());
+        glfwPollEvents();
+    });
     object_manager_.init();
+    object_manager_.set_loading_callback(nullptr);
+    glfwSetWindowTitle(window_, "Window");
+    loading_ = false;
+    check_gl_errors("Window::init()");
+
+    const ProgramCache::Stats& cache = program_cache().stats();
+    std::cout << "Program cache: " << cache.hits << " hits (" << cache.hit_time << "), " << cache.misses
+              << " misses (" << cache.miss_time << "), " << cache.rejected << " rejected\n";
 }
 
 //
@@ -96,11 +119,29 @@ bool Window::render_loop() {
         glfwPollEvents();
         // glfwWaitEvents();  // only need to rerender when something changes
 
+        object_manager_.update(0.f);
+
+        // Start building this frame's data on the worker threads. Until render() waits for it, this thread only does
+        // GL work which doesn't touch the managers.
+        const Eigen::Matrix3f screen_from_world = get_screen_from_world();
+        object_manager_.record(screen_from_world);
+
+        FrameUniforms uniforms;
+        uniforms.screen_from_world = screen_from_world;
+        uniforms.world_from_screen = screen_from_world.inverse();
+        uniforms.viewport = kWindowDim;
+        uniforms.time = glfwGetTime();
+        frame_uniforms_.update(uniforms);
+
+        // Spread texture uploads over frames, anything which isn't ready yet is drawn with a placeholder
+        texture_loader().update();
+
         gl_check(glClear, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         gl_check(glClearColor, 0.1f, 0.2f, 0.2f, 1.0f);
+        object_manager_.render(screen_from_world);
 
-        object_manager_.update(0.f);
-        object_manager_.render(get_screen_from_world());
+        // Individual calls are only checked in debug mode, so make sure nothing went wrong this frame
+        check_gl_errors("Window::render_loop()");
     }
 
     glfwSwapBuffers(window_);  // sleeps for 16ms (60hz)
@@ -159,7 +200,7 @@ void Window::handle_mouse_event(const MouseEvent& event) {
         double translate_factor = new_half_dim_.norm() / half_dim_.norm() - 1;
         center_ -= translate_factor * (scaled_event.mouse_position - center_);
         half_dim_ = new_half_dim_;
-    } else {
+    } else if (!loading_) {
         object_manager_.handle_mouse_event(scaled_event);
     }
 
@@ -181,7 +222,7 @@ void Window::handle_keyboard_event(const KeyboardEvent& event) {
         reset();
     }
 
-    object_manager_.handle_keyboard_event(event);
+    if (!loading_) object_manager_.handle_keyboard_event(event);
 }
 
 //
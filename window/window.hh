@@ -7,6 +7,7 @@
 #include <iostream>
 #include <mutex>
 
+#include "engine/frame_uniforms.hh"
 #include "engine/gl.hh"
 #include "engine/object_global.hh"
 
@@ -54,6 +55,12 @@ private:
 
     GlobalObjectManager object_manager_;
     std::mutex mutex_;
+
+    // Set while the managers are initialized, they don't get any events until that's done
+    bool loading_ = false;
+
+    // Camera, viewport and time shared with every shader, updated once per frame
+    FrameUniformBuffer frame_uniforms_;
 };
 
 }  // namespace engine